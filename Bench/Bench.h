@@ -0,0 +1,10 @@
+#pragma once
+
+// :      
+int bench_frames(int argc, char* argv[]);
+int bench_logger(int argc, char* argv[]);
+int bench_micro(int argc, char* argv[]);
+int bench_registry(int argc, char* argv[]);
+int bench_udp_pps(int argc, char* argv[]);
+int bench_udp_storm(int argc, char* argv[]);
+int bench_zerocopy(int argc, char* argv[]);
@@ -0,0 +1,105 @@
+#include "Bench.h"
+#include "../Common/radio_frame.h"
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <ctime>
+
+//   : ostringstream, put_time   to_string
+static std::string string_tick(uint32_t seq, int data, size_t clients) {
+    auto time = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    std::string result = "[RADIO] Time: ";
+    struct tm time_info;
+    localtime_s(&time_info, &time);
+    std::ostringstream oss;
+    oss << std::put_time(&time_info, "%Y-%m-%d %H:%M:%S");
+    result += oss.str();
+    result += " | Data: " + std::to_string(data);
+    result += " | Seq: " + std::to_string(seq);
+    result += " | Clients: " + std::to_string(clients);
+    return result;
+}
+
+//   : find_last_of, stoi  substr
+static int string_parse(const std::string& packet, std::string& command) {
+    command = packet;
+    int response_port = 0;
+    size_t last_space = command.find_last_of(' ');
+    if (last_space != std::string::npos) {
+        try {
+            response_port = std::stoi(command.substr(last_space + 1));
+            command = command.substr(0, last_space);
+        }
+        catch (...) {
+        }
+    }
+    return response_port;
+}
+
+template <typename Body>
+static double ns_per_op(long long iterations, Body body) {
+    auto start = std::chrono::steady_clock::now();
+    for (long long i = 0; i < iterations; ++i) body(i);
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()
+        / iterations;
+}
+
+static void print_row(const char* name, double string_ns, double binary_ns) {
+    std::cout << std::setw(18) << name
+        << std::setw(14) << std::fixed << std::setprecision(1) << string_ns
+        << std::setw(14) << binary_ns
+        << std::setw(9) << std::setprecision(1) << string_ns / binary_ns << "x" << std::endl;
+}
+
+int bench_frames(int argc, char* argv[]) {
+    long long iterations = argc > 0 ? std::stoll(argv[0]) : 1000000;
+    bool with_checksum = argc > 1 && std::string(argv[1]) == "checksum";
+    size_t sink = 0;
+
+    std::cout << "Radio frames: " << iterations << " iterations"
+        << (with_checksum ? ", with checksum" : "") << std::endl;
+    std::cout << std::setw(18) << "operation"
+        << std::setw(14) << "string ns/op"
+        << std::setw(14) << "binary ns/op"
+        << std::setw(10) << "speedup" << std::endl;
+
+    // :    (    )
+    double string_ns = ns_per_op(iterations, [&](long long i) {
+        sink += string_tick((uint32_t)i, 1234, 10).size();
+    });
+    char frame[radio_frame::MAX_FRAME];
+    double binary_ns = ns_per_op(iterations, [&](long long i) {
+        radio_frame::Tick tick;
+        tick.time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        tick.data = (uint32_t)i;
+        tick.clients = 10;
+        sink += radio_frame::encode_tick(frame, tick, with_checksum);
+    });
+    print_row("encode tick", string_ns, binary_ns);
+
+    // :  "ECHO text <port>"   ECHO
+    std::string text_packet = "ECHO hello radio 40000";
+    std::string command;
+    string_ns = ns_per_op(iterations, [&](long long) {
+        sink += string_parse(text_packet, command) + command.size();
+    });
+    size_t frame_size = radio_frame::encode_command(frame, radio_frame::ECHO, 40000,
+        "hello radio", 11, with_checksum);
+    binary_ns = ns_per_op(iterations, [&](long long) {
+        radio_frame::Header header;
+        const char* payload;
+        radio_frame::Command decoded;
+        if (radio_frame::decode(frame, frame_size, header, payload) == radio_frame::DecodeStatus::Ok &&
+            radio_frame::decode_command(header, payload, decoded)) {
+            sink += decoded.response_port + decoded.text_size;
+        }
+    });
+    print_row("parse command", string_ns, binary_ns);
+
+    if (sink == 0) std::cout << std::endl;    //    
+    return 0;
+}
@@ -0,0 +1,120 @@
+#include "Bench.h"
+#include "../Server/Logger.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+
+#ifdef _WIN32
+static const char* NULL_DEVICE = "NUL";
+#else
+static const char* NULL_DEVICE = "/dev/null";
+#endif
+
+//      , .    messages .
+template <typename Body>
+static double run_threads(int threads, long long messages, Body body) {
+    std::vector<std::thread> workers;
+    std::vector<double> ns(threads);
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            auto start = std::chrono::steady_clock::now();
+            for (long long i = 0; i < messages; ++i) body(t, i);
+            ns[t] = std::chrono::duration<double, std::nano>(
+                std::chrono::steady_clock::now() - start).count() / messages;
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    double total = 0;
+    for (double value : ns) total += value;
+    return total / threads;
+}
+
+int bench_logger(int argc, char* argv[]) {
+    const size_t BURST = Logger::RING_SIZE / 2;
+    long long messages = argc > 0 ? std::stoll(argv[0]) : 50000;
+    int max_threads = argc > 1 ? std::stoi(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+
+    //      :  ,   
+    FILE* sink = fopen(NULL_DEVICE, "w");
+    if (!sink) {
+        std::cerr << "Cannot open " << NULL_DEVICE << std::endl;
+        return 1;
+    }
+    Logger& logger = Logger::instance();
+    logger.set_output(sink);
+    logger.set_level(LogLevel::Info);
+
+    std::cout << "Logger: " << messages << " messages per thread" << std::endl;
+    std::cout << std::setw(8) << "threads"
+        << std::setw(16) << "fprintf ns/msg"
+        << std::setw(16) << "logger ns/msg"
+        << std::setw(10) << "dropped"
+        << std::setw(14) << "flood ns/msg"
+        << std::setw(16) << "flood dropped"
+        << std::setw(14) << "disabled ns" << std::endl;
+
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        //  :       
+        double direct_ns = run_threads(threads, messages, [&](int t, long long i) {
+            fprintf(sink, "[%d] 127.0.0.1:40000 -> PING %lld (response port: %d)\n", t, i, 40000);
+            fflush(sink);
+        });
+
+        //       :    
+        uint64_t dropped_before = logger.dropped();
+        double logger_ns = 0;
+        {
+            std::vector<std::thread> workers;
+            std::vector<double> ns(threads);
+            for (int t = 0; t < threads; ++t) {
+                workers.emplace_back([&, t]() {
+                    std::chrono::steady_clock::duration spent{};
+                    for (long long i = 0; i < messages;) {
+                        auto start = std::chrono::steady_clock::now();
+                        for (size_t n = 0; n < BURST && i < messages; ++n, ++i) {
+                            LOG_INFO("[%d] 127.0.0.1:40000 -> PING %lld (response port: %d)", t, i, 40000);
+                        }
+                        spent += std::chrono::steady_clock::now() - start;
+                        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                    }
+                    ns[t] = std::chrono::duration<double, std::nano>(spent).count() / messages;
+                });
+            }
+            for (auto& worker : workers) worker.join();
+            for (double value : ns) logger_ns += value / threads;
+        }
+        logger.flush();
+        uint64_t dropped = logger.dropped() - dropped_before;
+
+        //    :  ,  ,   
+        dropped_before = logger.dropped();
+        double flood_ns = run_threads(threads, messages, [&](int t, long long i) {
+            LOG_INFO("[%d] 127.0.0.1:40000 -> PING %lld (response port: %d)", t, i, 40000);
+        });
+        logger.flush();
+        uint64_t flood_dropped = logger.dropped() - dropped_before;
+
+        //  :  
+        double disabled_ns = run_threads(threads, messages, [&](int t, long long i) {
+            LOG_DEBUG("[%d] never formatted %lld", t, i);
+        });
+
+        std::cout << std::setw(8) << threads
+            << std::setw(16) << std::fixed << std::setprecision(1) << direct_ns
+            << std::setw(16) << logger_ns
+            << std::setw(10) << dropped
+            << std::setw(14) << flood_ns
+            << std::setw(16) << flood_dropped
+            << std::setw(14) << disabled_ns << std::endl;
+    }
+
+    logger.set_output(stdout);
+    fclose(sink);
+    return 0;
+}
@@ -0,0 +1,421 @@
+#include "Bench.h"
+#include "../Common/net_utils.h"
+#include "../Server/ClientManager.h"
+#include "../Server/ServerUDP.h"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef NET_LINUX
+#include <netinet/tcp.h>
+#endif
+
+//     :     
+//     
+class UdpServerProbe {
+public:
+    static int process(UdpRadioServer& server, const net_utils::UdpBuffer& packet, std::string& response) {
+        return server.process_command(packet, response);
+    }
+
+    static size_t broadcast(UdpRadioServer& server, uint32_t seq, char* out, bool binary) {
+        server.config_.binary_radio = binary;
+        return server.build_broadcast(seq, out);
+    }
+};
+
+namespace {
+    struct MicroResult {
+        std::string name;
+        double ns_per_op;       //  
+        double spread;          // ( - ) / 
+    };
+
+    const int ROUNDS = 5;
+    const double ROUND_NS = 50e6;      //   -  50 
+
+    // body(n)  n .   n  ROUND_NS,
+    //  ROUNDS ;      .
+    template <typename Body>
+    MicroResult measure(const std::string& name, Body body) {
+        auto run = [&](long long iterations) {
+            auto start = std::chrono::steady_clock::now();
+            body(iterations);
+            return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        };
+
+        long long iterations = 1;
+        double elapsed = run(iterations);
+        while (elapsed < ROUND_NS / 10 && iterations < (1ll << 40)) {
+            iterations *= 4;
+            elapsed = run(iterations);
+        }
+        iterations = std::max(1ll, (long long)(iterations * ROUND_NS / std::max(elapsed, 1.0)));
+
+        std::vector<double> samples;
+        for (int i = 0; i < ROUNDS; ++i) samples.push_back(run(iterations) / iterations);
+        std::sort(samples.begin(), samples.end());
+        double median = samples[ROUNDS / 2];
+        return { name, median, median > 0 ? (samples.back() - samples.front()) / median : 0 };
+    }
+
+    //   TCP-  loopback (socketpair   Windows)
+    void tcp_pair(net_utils::socket_t& a, net_utils::socket_t& b) {
+        net_utils::socket_t listener = net_utils::create_tcp_socket();
+        sockaddr_in addr;
+        net_utils::make_address("127.0.0.1", 0, addr);
+        socklen_t length = sizeof(addr);
+        if (listener == net_utils::INVALID_SOCKET_VAL ||
+            bind(listener, (sockaddr*)&addr, sizeof(addr)) == SOCKET_ERROR_VAL ||
+            listen(listener, 1) == SOCKET_ERROR_VAL ||
+            getsockname(listener, (sockaddr*)&addr, &length) == SOCKET_ERROR_VAL) {
+            net_utils::socket_close(listener);
+            throw std::runtime_error("Loopback listener failed");
+        }
+
+        a = net_utils::create_tcp_socket();
+        if (connect(a, (sockaddr*)&addr, sizeof(addr)) == SOCKET_ERROR_VAL) {
+            net_utils::socket_close(listener);
+            throw std::runtime_error("Loopback connect failed");
+        }
+        b = accept(listener, nullptr, nullptr);
+        net_utils::socket_close(listener);
+        if (b == net_utils::INVALID_SOCKET_VAL) throw std::runtime_error("Loopback accept failed");
+
+        //   ,     ACK (Nagle)
+        int on = 1;
+        setsockopt(a, IPPROTO_TCP, TCP_NODELAY, (const char*)&on, sizeof(on));
+        setsockopt(b, IPPROTO_TCP, TCP_NODELAY, (const char*)&on, sizeof(on));
+    }
+
+    //   :        
+    //  ,  ,   
+    class QueueShard : public ClientShard {
+    private:
+        std::vector<OutboundQueue> queues_;     //  ID 
+        std::vector<net_utils::SharedFrame> batch_;
+
+        void deliver(int client_id, const net_utils::SharedFrame& frame) {
+            OutboundQueue& queue = queues_[client_id];
+            queue.push(frame);
+            queue.pop_batch(batch_, 64);
+            batch_.clear();
+        }
+    public:
+        explicit QueueShard(size_t clients) : queues_(clients + 1) {}
+
+        void post_broadcast(const net_utils::SharedFrame& frame, int exclude_id) override {
+            for (size_t id = 1; id < queues_.size(); ++id) {
+                if ((int)id != exclude_id) deliver((int)id, frame);
+            }
+        }
+
+        void post_to_client(int client_id, const net_utils::SharedFrame& frame) override {
+            deliver(client_id, frame);
+        }
+
+        void post_overflow_policy(int, OverflowPolicy) override {
+        }
+
+        void post_to_members(const net_utils::SharedFrame& frame,
+            const RoomRouter::MemberList& members, int exclude_id) override {
+            for (int id : *members) {
+                if (id != exclude_id) deliver(id, frame);
+            }
+        }
+    };
+
+    //    ;   - 
+    struct Suite {
+        std::string filter;
+        std::vector<MicroResult> results;
+        size_t sink = 0;        //  :    
+
+        bool wanted(const std::string& name) const {
+            return filter.empty() || name.find(filter) != std::string::npos;
+        }
+
+        //   -  ,      
+        bool wanted_any(std::initializer_list<std::string> names) const {
+            for (const std::string& name : names) {
+                if (wanted(name)) return true;
+            }
+            return false;
+        }
+
+        template <typename Body>
+        void add(const std::string& name, Body body) {
+            if (!wanted(name)) return;
+            results.push_back(measure(name, body));
+            const MicroResult& result = results.back();
+            std::cout << "  " << std::left << std::setw(30) << result.name << std::right
+                << std::setw(12) << std::fixed << std::setprecision(1) << result.ns_per_op
+                << std::setw(8) << std::setprecision(1) << result.spread * 100 << "%" << std::endl;
+        }
+    };
+
+    void tcp_cases(Suite& suite) {
+        net_utils::socket_t a, b;
+        tcp_pair(a, b);
+
+        for (size_t size : { 64, 1024 }) {
+            std::string message(size, 'x');
+            //   : TCPsend + TCPread   
+            suite.add("tcp_roundtrip_" + std::to_string(size), [&](long long n) {
+                for (long long i = 0; i < n; ++i) {
+                    net_utils::TCPsend(a, message);
+                    std::string got = net_utils::TCPread(b);
+                    net_utils::TCPsend(b, got);
+                    suite.sink += net_utils::TCPread(a).size();
+                }
+            });
+        }
+
+        //  :  TCPsend,     FrameDecoder ( )
+        const int BURST = 32;
+        std::string message(64, 'x');
+        std::string got;
+        net_utils::FrameDecoder decoder;
+        suite.add("tcp_stream_decode_64", [&](long long n) {
+            for (long long i = 0; i < n; i += BURST) {
+                for (int k = 0; k < BURST; ++k) net_utils::TCPsend(a, message);
+                for (int k = 0; k < BURST; ++k) {
+                    if (decoder.receive(b, got) != net_utils::ReadStatus::Ok) {
+                        throw std::runtime_error("tcp_stream_decode_64: frame decoding failed");
+                    }
+                    suite.sink += got.size();
+                }
+            }
+        });
+
+        net_utils::socket_close(a);
+        net_utils::socket_close(b);
+    }
+
+    void udp_cases(Suite& suite) {
+        net_utils::socket_t sock = net_utils::create_udp_socket();
+        sockaddr_in self;
+        net_utils::make_address("127.0.0.1", 0, self);
+        socklen_t length = sizeof(self);
+        if (sock == net_utils::INVALID_SOCKET_VAL ||
+            bind(sock, (sockaddr*)&self, sizeof(self)) == SOCKET_ERROR_VAL ||
+            getsockname(sock, (sockaddr*)&self, &length) == SOCKET_ERROR_VAL) {
+            net_utils::socket_close(sock);
+            throw std::runtime_error("UDP socket failed");
+        }
+        int port = ntohs(self.sin_port);
+        std::string message(64, 'x');
+
+        //  :   ,       
+        suite.add("udp_send_receive_64", [&](long long n) {
+            for (long long i = 0; i < n; ++i) {
+                net_utils::send_udp_string(sock, message, "127.0.0.1", port);
+                suite.sink += net_utils::receive_udp(sock).data.size();
+            }
+        });
+
+        //   :  ,    
+        std::vector<char> storage(net_utils::UDP_MAX_PAYLOAD);
+        net_utils::UdpBuffer buffer{ storage.data(), storage.size(), 0, {} };
+        suite.add("udp_send_to_receive_into_64", [&](long long n) {
+            for (long long i = 0; i < n; ++i) {
+                net_utils::send_udp_to(sock, message.data(), message.size(), self);
+                if (net_utils::receive_udp_into(sock, buffer)) suite.sink += buffer.size;
+            }
+        });
+
+        net_utils::socket_close(sock);
+    }
+
+    void server_cases(Suite& suite) {
+        if (!suite.wanted_any({ "udp_command_ping", "udp_command_ping_port", "udp_command_echo",
+            "udp_command_hello", "udp_command_status", "udp_command_ping_binary",
+            "udp_broadcast_text", "udp_broadcast_binary" })) {
+            return;
+        }
+
+        //    ;       
+        //          
+        std::ostringstream banner;
+        std::streambuf* console = std::cout.rdbuf(banner.rdbuf());
+        std::unique_ptr<UdpRadioServer> server;
+        try {
+            server.reset(new UdpRadioServer());
+        }
+        catch (const std::exception& e) {
+            std::cout.rdbuf(console);
+            std::cout << "  (server cases skipped: " << e.what() << ")" << std::endl;
+            return;
+        }
+        std::cout.rdbuf(console);
+
+        sockaddr_in sender;
+        net_utils::make_address("127.0.0.1", 40000, sender);
+        std::string response;
+        response.reserve(radio_frame::MAX_FRAME);
+
+        auto command_case = [&](const std::string& name, const std::string& command) {
+            std::string data = command;
+            net_utils::UdpBuffer packet{ &data[0], data.size(), data.size(), sender };
+            suite.add(name, [&](long long n) {
+                for (long long i = 0; i < n; ++i) {
+                    response.clear();
+                    suite.sink += UdpServerProbe::process(*server, packet, response) + response.size();
+                }
+            });
+        };
+
+        command_case("udp_command_ping", "PING");
+        command_case("udp_command_ping_port", "PING 40001");
+        command_case("udp_command_echo", "ECHO hello radio");
+        command_case("udp_command_hello", "HELLO 40001");
+        command_case("udp_command_status", "STATUS");
+
+        char frame[radio_frame::MAX_FRAME];
+        size_t size = radio_frame::encode_bytes(frame, radio_frame::PING, nullptr, 0, false);
+        command_case("udp_command_ping_binary", std::string(frame, size));
+
+        char out[512];
+        for (bool binary : { false, true }) {
+            suite.add(binary ? "udp_broadcast_binary" : "udp_broadcast_text", [&](long long n) {
+                for (long long i = 0; i < n; ++i) {
+                    suite.sink += UdpServerProbe::broadcast(*server, (uint32_t)i, out, binary);
+                }
+            });
+        }
+
+        std::cout.rdbuf(banner.rdbuf());
+        server.reset();
+        std::cout.rdbuf(console);
+    }
+
+    void registry_cases(Suite& suite) {
+        for (int clients : { 1000, 10000 }) {
+            std::string suffix = "_" + std::to_string(clients);
+            if (!suite.wanted_any({ "registry_lookup" + suffix, "registry_scan" + suffix,
+                "registry_broadcast" + suffix, "registry_room" + suffix })) {
+                continue;
+            }
+
+            std::unique_ptr<ClientManager> registry(new ClientManager());
+            QueueShard shard(clients);
+            registry->attach_shards({ &shard });
+
+            sockaddr_in address;
+            memset(&address, 0, sizeof(address));
+            for (int i = 0; i < clients; ++i) {
+                int id = registry->add_client(net_utils::INVALID_SOCKET_VAL, address, 0);
+                if (i % 10 == 0) registry->join_room(id, "bench");
+            }
+
+            std::mt19937 gen(1);
+            std::uniform_int_distribution<int> pick(1, clients);
+            std::vector<int> ids(4096);
+            for (int& id : ids) id = pick(gen);
+
+            suite.add("registry_lookup" + suffix, [&](long long n) {
+                for (long long i = 0; i < n; ++i) {
+                    suite.sink += registry->get_client_name(ids[i & 4095]).size();
+                }
+            });
+            suite.add("registry_scan" + suffix, [&](long long n) {
+                for (long long i = 0; i < n; ++i) suite.sink += registry->get_connected_clients().size();
+            });
+
+            std::string message(64, 'x');
+            suite.add("registry_broadcast" + suffix, [&](long long n) {
+                for (long long i = 0; i < n; ++i) registry->broadcast_message(message, 1);
+            });
+            suite.add("registry_room" + suffix, [&](long long n) {
+                for (long long i = 0; i < n; ++i) registry->room_message("bench", message, 1);
+            });
+        }
+    }
+
+    //  : " __"  , # - 
+    std::map<std::string, double> read_results(const std::string& path) {
+        std::ifstream file(path);
+        if (!file) throw std::runtime_error("Cannot read baseline: " + path);
+        std::map<std::string, double> results;
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            std::istringstream fields(line);
+            std::string name;
+            double ns;
+            if (fields >> name >> ns) results[name] = ns;
+        }
+        return results;
+    }
+
+    void write_results(const std::string& path, const std::vector<MicroResult>& results) {
+        std::ofstream file(path);
+        if (!file) throw std::runtime_error("Cannot write results: " + path);
+        file << "# name ns_per_op spread" << std::endl;
+        for (const MicroResult& result : results) {
+            file << result.name << " " << std::fixed << std::setprecision(2) << result.ns_per_op
+                << " " << std::setprecision(3) << result.spread << std::endl;
+        }
+    }
+}
+
+//    .    ,
+//    :   tolerance % -  ( 2).
+int bench_micro(int argc, char* argv[]) {
+    std::string output = argc > 0 ? argv[0] : "-";
+    std::string baseline = argc > 1 ? argv[1] : "-";
+    double tolerance = argc > 2 ? std::stod(argv[2]) : 20.0;
+    Suite suite;
+    suite.filter = argc > 3 ? argv[3] : "";
+
+    std::map<std::string, double> base;
+    if (baseline != "-") base = read_results(baseline);
+
+    if (!net_utils::net_init()) {
+        throw std::runtime_error("Network init failed");
+    }
+
+    std::cout << "Microbenchmarks: median of " << ROUNDS << " rounds" << std::endl;
+    std::cout << "  " << std::left << std::setw(30) << "case" << std::right
+        << std::setw(12) << "ns/op" << std::setw(9) << "spread" << std::endl;
+
+    tcp_cases(suite);
+    udp_cases(suite);
+    server_cases(suite);
+    registry_cases(suite);
+    net_utils::net_cleanup();
+    if (suite.sink == 0) std::cout << std::endl;
+
+    if (output != "-") write_results(output, suite.results);
+    if (base.empty()) return 0;
+
+    int regressions = 0;
+    std::cout << "Against " << baseline << " (tolerance " << tolerance << "%):" << std::endl;
+    for (const MicroResult& result : suite.results) {
+        auto it = base.find(result.name);
+        if (it == base.end()) {
+            std::cout << "  " << std::left << std::setw(30) << result.name << std::right << "    new" << std::endl;
+            continue;
+        }
+        double change = (result.ns_per_op / it->second - 1) * 100;
+        bool slower = change > tolerance;
+        regressions += slower;
+        std::cout << "  " << std::left << std::setw(30) << result.name << std::right
+            << std::setw(12) << std::setprecision(1) << it->second
+            << std::setw(12) << result.ns_per_op
+            << std::setw(8) << std::showpos << change << std::noshowpos << "%"
+            << (slower ? "  REGRESSION" : "") << std::endl;
+    }
+    std::cout << "RESULT cases=" << suite.results.size() << " regressions=" << regressions << std::endl;
+    return regressions ? 2 : 0;
+}
@@ -0,0 +1,135 @@
+#include "Bench.h"
+#include "../Server/ClientManager.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <random>
+
+//  : std::map    ( )
+class MapRegistry {
+private:
+    struct Client {
+        std::string name;
+        bool connected;
+    };
+
+    std::map<int, Client> clients_;
+    std::mutex clients_mutex_;
+    int next_client_id_ = 1;
+public:
+    int add_client(net_utils::socket_t, struct sockaddr_in, int) {
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        int new_id = next_client_id_++;
+        clients_[new_id] = { "User" + std::to_string(new_id), true };
+        return new_id;
+    }
+
+    std::string get_client_name(int client_id) {
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        auto it = clients_.find(client_id);
+        return it != clients_.end() ? it->second.name : "Unknown";
+    }
+
+    void set_client_name(int client_id, const std::string& name) {
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        auto it = clients_.find(client_id);
+        if (it != clients_.end()) it->second.name = name;
+    }
+
+    std::vector<int> get_connected_clients() {
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        std::vector<int> result;
+        for (const auto& pair : clients_) {
+            if (pair.second.connected) result.push_back(pair.first);
+        }
+        return result;
+    }
+};
+
+// :   ,    (/users).
+//     ~10 .   .
+template <typename Registry>
+static double run_contention(Registry& registry, int clients, int readers, double seconds) {
+    std::atomic<bool> running{ true };
+    std::atomic<long long> total_reads{ 0 };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < readers; ++t) {
+        threads.emplace_back([&, t]() {
+            std::mt19937 gen(t + 1);
+            std::uniform_int_distribution<int> pick(1, clients);
+            long long reads = 0;
+            size_t sink = 0;
+            while (running.load(std::memory_order_relaxed)) {
+                for (int i = 0; i < 256; ++i) {
+                    sink += registry.get_client_name(pick(gen)).size();
+                }
+                reads += 256;
+                if (reads % (256 * 64) == 0) {
+                    sink += registry.get_connected_clients().size();
+                }
+            }
+            total_reads += reads + (sink == 0 ? 1 : 0);
+        });
+    }
+
+    std::thread writer([&]() {
+        std::mt19937 gen(12345);
+        std::uniform_int_distribution<int> pick(1, clients);
+        int renames = 0;
+        while (running.load(std::memory_order_relaxed)) {
+            registry.set_client_name(pick(gen), "Renamed" + std::to_string(renames++));
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    running = false;
+    for (auto& thread : threads) thread.join();
+    writer.join();
+
+    return total_reads / seconds;
+}
+
+int bench_registry(int argc, char* argv[]) {
+    int clients = argc > 0 ? std::stoi(argv[0]) : 1000;
+    double seconds = argc > 1 ? std::stod(argv[1]) : 1.0;
+    int max_threads = argc > 2 ? std::stoi(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+
+    //   -   
+    static MapRegistry map_registry;
+    static ClientManager rcu_registry;
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    for (int i = 0; i < clients; ++i) {
+        map_registry.add_client(net_utils::INVALID_SOCKET_VAL, address, 0);
+        rcu_registry.add_client(net_utils::INVALID_SOCKET_VAL, address, 0);
+    }
+
+    std::cout << "Registry contention: " << clients << " clients, "
+        << seconds << " s per run, 1 writer" << std::endl;
+    std::cout << std::setw(8) << "readers"
+        << std::setw(18) << "map+mutex ops/s"
+        << std::setw(18) << "rcu ops/s"
+        << std::setw(10) << "speedup" << std::endl;
+
+    for (int readers = 1; readers <= max_threads; readers *= 2) {
+        double map_ops = run_contention(map_registry, clients, readers, seconds);
+        double rcu_ops = run_contention(rcu_registry, clients, readers, seconds);
+
+        std::cout << std::setw(8) << readers
+            << std::setw(18) << std::fixed << std::setprecision(0) << map_ops
+            << std::setw(18) << rcu_ops
+            << std::setw(9) << std::setprecision(2) << rcu_ops / map_ops << "x" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include "Bench.h"
+#include "../Common/net_utils.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+
+//     UdpRadioServer:  window  PING
+//       .   (--batch=N) 
+//    ;  batch    .
+int bench_udp_pps(int argc, char* argv[]) {
+    size_t batch = argc > 0 ? std::stoul(argv[0]) : 64;
+    double seconds = argc > 1 ? std::stod(argv[1]) : 5.0;
+    size_t window = argc > 2 ? std::stoul(argv[2]) : 1024;
+    std::string host = argc > 3 ? argv[3] : "127.0.0.1";
+    int port = argc > 4 ? std::stoi(argv[4]) : 12346;
+
+    if (!net_utils::net_init()) {
+        throw std::runtime_error("Network init failed");
+    }
+
+    net_utils::socket_t sock = net_utils::create_udp_socket();
+    if (sock == net_utils::INVALID_SOCKET_VAL) {
+        throw std::runtime_error("Socket creation failed");
+    }
+
+    sockaddr_in server;
+    if (!net_utils::make_address(host.c_str(), port, server)) {
+        net_utils::socket_close(sock);
+        throw std::runtime_error("Wrong server address: " + host);
+    }
+
+    //         
+    const std::string command = "PING";
+    net_utils::UdpSendBatch requests(batch);
+    net_utils::UdpReceiveBatch replies(batch, 2048);
+
+    long long sent = 0, received = 0, lost = 0;
+    size_t in_flight = 0;
+
+    std::cout << "UDP command load: " << host << ":" << port << ", batch " << batch
+        << ", window " << window << ", " << seconds << " s" << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(seconds));
+
+    while (std::chrono::steady_clock::now() < deadline) {
+        while (in_flight + requests.count() < window && !requests.full()) {
+            requests.add(command, server);
+        }
+        if (requests.count() > 0) {
+            size_t done = requests.flush(sock);
+            sent += done;
+            in_flight += done;
+        }
+
+        int got = replies.receive(sock, in_flight > 0 ? 50 : 0);
+        if (got > 0) {
+            received += got;
+            in_flight -= std::min<size_t>(got, in_flight);
+        }
+        else if (in_flight > 0) {
+            // 50   - ,   ,  
+            lost += in_flight;
+            in_flight = 0;
+        }
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    net_utils::socket_close(sock);
+    net_utils::net_cleanup();
+
+    std::cout << "Sent: " << sent << ", received: " << received
+        << ", lost: " << lost << ", in flight at stop: " << in_flight << std::endl;
+    std::cout << "Responses/s: " << std::fixed << std::setprecision(0)
+        << received / elapsed << std::endl;
+    return 0;
+}
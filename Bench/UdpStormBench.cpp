@@ -0,0 +1,293 @@
+#include "Bench.h"
+#include "../Common/net_utils.h"
+#include "../Client/GapTracker.h"
+#include "../Server/Metrics.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdlib>
+
+namespace {
+    enum CommandKind { HELLO, PING, STATUS, ECHO, KIND_COUNT };
+
+    const char* KIND_NAMES[KIND_COUNT] = { "HELLO", "PING", "STATUS", "ECHO" };
+    const uint64_t REQUEST_TIMEOUT_NS = 1000000000ull;     //    - 
+    const char ECHO_TAG[] = "storm:";
+
+    //   ->    (  )
+    int kind_of(const char* data, size_t size) {
+        static const struct { const char* prefix; int kind; } replies[] = {
+            { "WELCOME", HELLO }, { "PONG", PING }, { "SERVER STATUS", STATUS }, { "ECHO: ", ECHO }
+        };
+        for (const auto& reply : replies) {
+            size_t length = strlen(reply.prefix);
+            if (size >= length && memcmp(data, reply.prefix, length) == 0) return reply.kind;
+        }
+        return -1;
+    }
+
+    //   ,      .
+    //       ,    
+    //       . ECHO    .
+    struct StormSocket {
+        net_utils::socket_t socket;
+        net_utils::UdpSendBatch requests;
+        std::deque<uint64_t> pending[KIND_COUNT];   //     
+
+        explicit StormSocket(size_t batch) : socket(net_utils::INVALID_SOCKET_VAL), requests(batch) {}
+    };
+
+    struct KindStats {
+        long long sent = 0;
+        long long answered = 0;
+        long long lost = 0;
+    };
+
+    //     :  poll   
+    int wait_any(std::vector<net_utils::socket_t>& sockets, std::vector<bool>& ready, int timeout_ms) {
+        #ifdef NET_WINDOWS
+        std::vector<WSAPOLLFD> fds(sockets.size());
+        for (size_t i = 0; i < sockets.size(); ++i) fds[i] = { sockets[i], POLLRDNORM, 0 };
+        int count = WSAPoll(fds.data(), (ULONG)fds.size(), timeout_ms);
+        #else
+        std::vector<pollfd> fds(sockets.size());
+        for (size_t i = 0; i < sockets.size(); ++i) fds[i] = { sockets[i], POLLIN, 0 };
+        int count = poll(fds.data(), fds.size(), timeout_ms);
+        #endif
+        for (size_t i = 0; i < sockets.size(); ++i) ready[i] = count > 0 && fds[i].revents != 0;
+        return count;
+    }
+
+    // "1:5:1:3" ->  HELLO, PING, STATUS, ECHO ->   
+    std::vector<int> parse_mix(const std::string& text) {
+        std::vector<int> pattern;
+        size_t begin = 0;
+        for (int kind = 0; kind < KIND_COUNT && begin <= text.size(); ++kind) {
+            size_t end = text.find(':', begin);
+            if (end == std::string::npos) end = text.size();
+            int weight = begin < end ? std::stoi(text.substr(begin, end - begin)) : 0;
+            for (int i = 0; i < weight; ++i) pattern.push_back(kind);
+            begin = end + 1;
+        }
+        if (pattern.empty()) throw std::runtime_error("Empty command mix: " + text);
+        return pattern;
+    }
+}
+
+//         .
+//    rate      mix;  RTT  
+// ,  (   )     .
+int bench_udp_storm(int argc, char* argv[]) {
+    size_t clients = argc > 0 ? std::stoul(argv[0]) : 10000;
+    double rate = argc > 1 ? std::stod(argv[1]) : 1.0;
+    double seconds = argc > 2 ? std::stod(argv[2]) : 10.0;
+    size_t socket_count = argc > 3 ? std::max<size_t>(1, std::stoul(argv[3])) : 4;
+    std::vector<int> pattern = parse_mix(argc > 4 ? argv[4] : "1:5:1:3");
+    std::string host = argc > 5 ? argv[5] : "127.0.0.1";
+    std::string group = argc > 6 ? argv[6] : "";
+    const int COMMAND_PORT = 12346;
+    const int BROADCAST_PORT = 12345;
+    const size_t BATCH = 64;
+
+    if (!net_utils::net_init()) {
+        throw std::runtime_error("Network init failed");
+    }
+
+    sockaddr_in server;
+    if (!net_utils::make_address(host.c_str(), COMMAND_PORT, server)) {
+        throw std::runtime_error("Wrong server address: " + host);
+    }
+
+    //  :    ,     
+    std::vector<std::unique_ptr<StormSocket>> sockets;
+    std::vector<net_utils::socket_t> poll_sockets;
+    for (size_t i = 0; i < socket_count; ++i) {
+        sockets.emplace_back(new StormSocket(BATCH));
+        sockets.back()->socket = net_utils::create_udp_socket();
+        if (sockets.back()->socket == net_utils::INVALID_SOCKET_VAL ||
+            !net_utils::bind_socket(sockets.back()->socket, 0)) {
+            throw std::runtime_error("Command socket failed");
+        }
+        poll_sockets.push_back(sockets.back()->socket);
+    }
+
+    // :   ,     (   )
+    net_utils::socket_t radio = net_utils::create_udp_socket();
+    net_utils::enable_reuse_address(radio);
+    if (radio == net_utils::INVALID_SOCKET_VAL || !net_utils::bind_socket(radio, BROADCAST_PORT) ||
+        (!group.empty() && !net_utils::join_multicast(radio, group.c_str()))) {
+        throw std::runtime_error("Broadcast socket failed");
+    }
+    poll_sockets.push_back(radio);
+
+    std::cout << "UDP command storm: " << host << ":" << COMMAND_PORT << ", " << clients
+        << " virtual clients over " << socket_count << " sockets, " << rate << " req/s each, "
+        << seconds << " s" << std::endl;
+
+    net_utils::UdpReceiveBatch replies(BATCH, 2048);
+    std::vector<bool> ready(poll_sockets.size());
+    Histogram rtt[KIND_COUNT];
+    Histogram all_rtt;
+    KindStats kinds[KIND_COUNT];
+    long long unmatched = 0, broadcasts = 0;
+    uint64_t max_lag = 0;                   //    
+    GapTracker gaps;
+    char command[64];
+
+    //  :  k -   k % clients
+    double interval_ns = 1e9 / (rate * clients);
+    uint64_t start = Histogram::now_ns();
+    uint64_t end = start + (uint64_t)(seconds * 1e9);
+    uint64_t stop = end + REQUEST_TIMEOUT_NS;
+    long long next_index = 0;
+    uint64_t next_ns = start;
+
+    auto expire = [&](uint64_t now) {
+        for (auto& sock : sockets) {
+            for (int kind = 0; kind < KIND_COUNT; ++kind) {
+                std::deque<uint64_t>& pending = sock->pending[kind];
+                while (!pending.empty() && now - pending.front() > REQUEST_TIMEOUT_NS) {
+                    pending.pop_front();
+                    ++kinds[kind].lost;
+                }
+            }
+        }
+    };
+
+    uint64_t last_expire = start;
+    while (true) {
+        uint64_t now = Histogram::now_ns();
+        if (now >= stop) break;
+
+        // ,   , -    .    -
+        //        ,    
+        size_t burst = 0;
+        if (next_ns < end && now > next_ns) max_lag = std::max(max_lag, now - next_ns);
+        while (next_ns <= now && next_ns < end && burst++ < BATCH * socket_count) {
+            size_t client = (size_t)(next_index % clients);
+            StormSocket& sock = *sockets[client % socket_count];
+            int kind = pattern[(size_t)(next_index / clients + client) % pattern.size()];
+
+            int length = kind == ECHO ?
+                snprintf(command, sizeof(command), "ECHO %s%llu", ECHO_TAG, (unsigned long long)next_ns) :
+                snprintf(command, sizeof(command), "%s", KIND_NAMES[kind]);
+            sock.requests.add(command, length, server);
+            if (kind != ECHO) sock.pending[kind].push_back(next_ns);
+            ++kinds[kind].sent;
+            if (sock.requests.full()) sock.requests.flush(sock.socket);
+
+            ++next_index;
+            next_ns = start + (uint64_t)(next_index * interval_ns);
+        }
+        for (auto& sock : sockets) {
+            if (sock->requests.count()) sock->requests.flush(sock->socket);
+        }
+
+        now = Histogram::now_ns();
+        uint64_t wake = next_ns < end ? next_ns : stop;
+        int timeout_ms = wake > now ? (int)std::min<uint64_t>((wake - now) / 1000000, 10) : 0;
+        if (wait_any(poll_sockets, ready, timeout_ms) > 0) {
+            now = Histogram::now_ns();
+            for (size_t i = 0; i < sockets.size(); ++i) {
+                if (!ready[i]) continue;
+                StormSocket& sock = *sockets[i];
+                int got = replies.receive(sock.socket, 0);
+                for (int r = 0; r < got; ++r) {
+                    const net_utils::UdpBuffer& reply = replies.packet(r);
+                    int kind = kind_of(reply.data, reply.size);
+                    uint64_t sent_ns = 0;
+                    if (kind == ECHO) {
+                        // "ECHO: storm:<>" -     
+                        std::string text(reply.data, reply.size);
+                        size_t tag = text.find(ECHO_TAG);
+                        if (tag == std::string::npos) kind = -1;
+                        else sent_ns = strtoull(text.c_str() + tag + sizeof(ECHO_TAG) - 1, nullptr, 10);
+                    }
+                    else if (kind >= 0) {
+                        if (sock.pending[kind].empty()) kind = -1;  //     
+                        else {
+                            sent_ns = sock.pending[kind].front();
+                            sock.pending[kind].pop_front();
+                        }
+                    }
+                    if (kind < 0) {
+                        ++unmatched;
+                        continue;
+                    }
+                    uint64_t elapsed = now > sent_ns ? now - sent_ns : 0;
+                    rtt[kind].record(elapsed);
+                    all_rtt.record(elapsed);
+                    ++kinds[kind].answered;
+                }
+            }
+
+            if (ready.back()) {
+                int got = replies.receive(radio, 0);
+                for (int r = 0; r < got; ++r) {
+                    uint32_t seq;
+                    uint8_t flags;
+                    const net_utils::UdpBuffer& packet = replies.packet(r);
+                    if (!net_utils::read_radio_header(packet.data, packet.size, seq, flags)) continue;
+                    ++broadcasts;
+                    gaps.on_packet(seq, GapTracker::now_ms());
+                }
+            }
+        }
+
+        //      10 
+        if (now - last_expire > 10000000) {
+            expire(now);
+            last_expire = now;
+        }
+    }
+
+    // ECHO        
+    expire(UINT64_MAX / 2);
+    kinds[ECHO].lost = kinds[ECHO].sent - kinds[ECHO].answered;
+
+    for (auto& sock : sockets) net_utils::socket_close(sock->socket);
+    net_utils::socket_close(radio);
+    net_utils::net_cleanup();
+
+    long long sent = 0, answered = 0, lost = 0;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << std::setw(8) << "command" << std::setw(10) << "sent" << std::setw(10) << "answered"
+        << std::setw(9) << "lost %" << std::setw(11) << "p50 us" << std::setw(11) << "p99 us"
+        << std::setw(11) << "p999 us" << std::setw(11) << "max us" << std::endl;
+    for (int kind = 0; kind < KIND_COUNT; ++kind) {
+        Histogram::Snapshot snapshot = rtt[kind].snapshot();
+        sent += kinds[kind].sent;
+        answered += kinds[kind].answered;
+        lost += kinds[kind].lost;
+        std::cout << std::setw(8) << KIND_NAMES[kind] << std::setw(10) << kinds[kind].sent
+            << std::setw(10) << kinds[kind].answered
+            << std::setw(9) << (kinds[kind].sent ? 100.0 * kinds[kind].lost / kinds[kind].sent : 0.0)
+            << std::setw(11) << snapshot.percentile(0.5) / 1000.0
+            << std::setw(11) << snapshot.percentile(0.99) / 1000.0
+            << std::setw(11) << snapshot.percentile(0.999) / 1000.0
+            << std::setw(11) << snapshot.max / 1000.0 << std::endl;
+    }
+
+    Histogram::Snapshot total = all_rtt.snapshot();
+    GapTracker::Stats radio_stats = gaps.stats();
+    std::cout << "Requests/s: " << sent / seconds << ", responses/s: " << answered / seconds
+        << ", lost: " << lost << " (" << (sent ? 100.0 * lost / sent : 0.0) << "%), unmatched: "
+        << unmatched << ", generator lag max: " << max_lag / 1000000.0 << " ms" << std::endl;
+    std::cout << "Broadcasts: " << broadcasts << ", gaps: " << radio_stats.gaps << ", late: "
+        << radio_stats.recovered << ", never arrived: " << gaps.pending() + radio_stats.lost
+        << ", duplicates: " << radio_stats.duplicates << std::endl;
+
+    std::cout << "RESULT clients=" << clients << " sockets=" << socket_count << " rate=" << rate
+        << " sent=" << sent << " answered=" << answered << " lost=" << lost
+        << " pps=" << answered / seconds
+        << " p50_us=" << total.percentile(0.5) / 1000.0 << " p99_us=" << total.percentile(0.99) / 1000.0
+        << " p999_us=" << total.percentile(0.999) / 1000.0 << " max_us=" << total.max / 1000.0
+        << " lag_ms=" << max_lag / 1000000.0 << " broadcast_gaps=" << radio_stats.gaps << std::endl;
+    return 0;
+}
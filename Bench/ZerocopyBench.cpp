@@ -0,0 +1,168 @@
+#include "Bench.h"
+#include "../Common/net_utils.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <ctime>
+#include <stdexcept>
+
+//    ,  ( Linux -  )
+static double thread_cpu_seconds() {
+    #ifdef NET_LINUX
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+    #else
+    return (double)std::clock() / CLOCKS_PER_SEC;
+    #endif
+}
+
+//   loopback:   .  .
+static int start_sink(std::thread& thread) {
+    net_utils::socket_t listener = net_utils::create_tcp_socket();
+    sockaddr_in addr;
+    net_utils::make_address("127.0.0.1", 0, addr);
+    socklen_t length = sizeof(addr);
+    if (listener == net_utils::INVALID_SOCKET_VAL ||
+        bind(listener, (sockaddr*)&addr, sizeof(addr)) == SOCKET_ERROR_VAL ||
+        listen(listener, 4) == SOCKET_ERROR_VAL ||
+        getsockname(listener, (sockaddr*)&addr, &length) == SOCKET_ERROR_VAL) {
+        net_utils::socket_close(listener);
+        throw std::runtime_error("Loopback listener failed");
+    }
+
+    //   -   
+    thread = std::thread([listener]() {
+        std::vector<char> buffer(1 << 20);
+        for (int run = 0; run < 2; ++run) {
+            net_utils::socket_t client = accept(listener, nullptr, nullptr);
+            if (client == net_utils::INVALID_SOCKET_VAL) break;
+            while (recv(client, buffer.data(), (int)buffer.size(), 0) > 0) {
+            }
+            net_utils::socket_close(client);
+        }
+        net_utils::socket_close(listener);
+    });
+    return ntohs(addr.sin_port);
+}
+
+struct SendRun {
+    double bytes = 0;
+    double cpu_seconds = 0;
+    double seconds = 0;
+    long long zerocopy_sends = 0;   //   MSG_ZEROCOPY
+    long long copied = 0;           //    - 
+};
+
+//       (  ) seconds 
+static SendRun send_for(const sockaddr_in& target, const std::string& frame, double seconds, bool zerocopy) {
+    net_utils::socket_t sock = net_utils::create_tcp_socket();
+    if (sock == net_utils::INVALID_SOCKET_VAL ||
+        connect(sock, (const sockaddr*)&target, sizeof(target)) == SOCKET_ERROR_VAL) {
+        net_utils::socket_close(sock);
+        throw std::runtime_error("Connect to sink failed");
+    }
+    if (zerocopy && !net_utils::enable_zerocopy(sock)) {
+        net_utils::socket_close(sock);
+        throw std::runtime_error("SO_ZEROCOPY is not supported here");
+    }
+
+    SendRun run;
+    long long completed = 0;
+    auto on_done = [&](uint32_t first, uint32_t last, bool copied) {
+        completed += last - first + 1;
+        if (copied) run.copied += last - first + 1;
+    };
+
+    double cpu_start = thread_cpu_seconds();
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(seconds));
+    while (std::chrono::steady_clock::now() < deadline) {
+        net_utils::IoSlice slice = { frame.data(), frame.size() };
+        bool use_zerocopy = zerocopy;
+        long sent = net_utils::send_slices(sock, &slice, 1, true, &use_zerocopy);
+        if (sent <= 0) {
+            net_utils::socket_close(sock);
+            throw std::runtime_error("Send to sink failed");
+        }
+        run.bytes += sent;
+        if (use_zerocopy) {
+            ++run.zerocopy_sends;
+            net_utils::read_zerocopy_completions(sock, on_done);
+        }
+    }
+    //   ,      
+    while (completed < run.zerocopy_sends) {
+        net_utils::wait_readable(sock, 10);
+        if (!net_utils::read_zerocopy_completions(sock, on_done)) break;
+    }
+    run.cpu_seconds = thread_cpu_seconds() - cpu_start;
+    run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    net_utils::socket_close(sock);
+    return run;
+}
+
+static void print_run(const char* name, const SendRun& run) {
+    double gigabytes = run.bytes / 1e9;
+    std::cout << std::setw(10) << name
+        << std::setw(10) << std::fixed << std::setprecision(2) << gigabytes
+        << std::setw(10) << std::setprecision(3) << run.cpu_seconds
+        << std::setw(14) << std::setprecision(1) << run.cpu_seconds * 1000 / gigabytes
+        << std::setw(10) << std::setprecision(2) << run.bytes * 8 / 1e9 / run.seconds << std::endl;
+}
+
+//       MSG_ZEROCOPY:     .
+//   -   loopback;     (copied =  ),
+//            .
+int bench_zerocopy(int argc, char* argv[]) {
+    size_t size = argc > 0 ? std::stoul(argv[0]) : 65536;
+    double seconds = argc > 1 ? std::stod(argv[1]) : 3.0;
+    std::string host = argc > 2 ? argv[2] : "";
+    int port = argc > 3 ? std::stoi(argv[3]) : 12347;
+
+    if (!net_utils::net_init()) {
+        throw std::runtime_error("Network init failed");
+    }
+
+    std::thread sink;
+    if (host.empty()) {
+        port = start_sink(sink);
+        host = "127.0.0.1";
+    }
+    sockaddr_in target;
+    if (!net_utils::make_address(host.c_str(), port, target)) {
+        throw std::runtime_error("Wrong sink address: " + host);
+    }
+
+    std::string frame(size, 'z');
+    std::cout << "Sending " << size << "-byte frames to " << host << ":" << port
+        << ", " << seconds << " s per mode" << std::endl;
+
+    SendRun copy = send_for(target, frame, seconds, false);
+    SendRun zerocopy = send_for(target, frame, seconds, true);
+    if (sink.joinable()) sink.join();
+    net_utils::net_cleanup();
+
+    std::cout << std::setw(10) << "mode" << std::setw(10) << "GB" << std::setw(10) << "cpu s"
+        << std::setw(14) << "cpu ms/GB" << std::setw(10) << "Gbit/s" << std::endl;
+    print_run("copy", copy);
+    print_run("zerocopy", zerocopy);
+
+    double copy_ms = copy.cpu_seconds * 1000 / (copy.bytes / 1e9);
+    double zerocopy_ms = zerocopy.cpu_seconds * 1000 / (zerocopy.bytes / 1e9);
+    std::cout << "CPU saved: " << std::setprecision(1) << copy_ms - zerocopy_ms << " ms per GB ("
+        << std::setprecision(0) << (copy_ms - zerocopy_ms) * 100 / copy_ms << "%)" << std::endl;
+    std::cout << "Kernel copied " << zerocopy.copied << " of " << zerocopy.zerocopy_sends
+        << " zero-copy sends" << (zerocopy.copied ? " (loopback or no scatter-gather: no gain)" : "")
+        << std::endl;
+    std::cout << "RESULT size=" << size << " copy_ms_per_gb=" << std::setprecision(1) << copy_ms
+        << " zerocopy_ms_per_gb=" << zerocopy_ms << " saved_ms_per_gb=" << copy_ms - zerocopy_ms
+        << " copied=" << zerocopy.copied << " sends=" << zerocopy.zerocopy_sends << std::endl;
+    return 0;
+}
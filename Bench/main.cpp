@@ -0,0 +1,32 @@
+#include "Bench.h"
+
+#include <iostream>
+#include <string>
+
+int main(int argc, char* argv[]) {
+    std::string name = argc > 1 ? argv[1] : "";
+
+    try {
+        if (name == "frames") return bench_frames(argc - 2, argv + 2);
+        if (name == "logger") return bench_logger(argc - 2, argv + 2);
+        if (name == "micro") return bench_micro(argc - 2, argv + 2);
+        if (name == "registry") return bench_registry(argc - 2, argv + 2);
+        if (name == "udp-pps") return bench_udp_pps(argc - 2, argv + 2);
+        if (name == "udp-storm") return bench_udp_storm(argc - 2, argv + 2);
+        if (name == "zerocopy") return bench_zerocopy(argc - 2, argv + 2);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Usage: Bench <name> [options]" << std::endl;
+    std::cout << "  frames [iterations] [checksum] - radio tick/command: string path vs binary frames" << std::endl;
+    std::cout << "  logger [messages] [max threads] - async logger vs fprintf, ns per message" << std::endl;
+    std::cout << "  micro [results|-] [baseline|-] [tolerance %] [filter] - hot-path microbenchmarks, regression check" << std::endl;
+    std::cout << "  registry [clients] [seconds] [max readers] - ClientManager vs map+mutex under contention" << std::endl;
+    std::cout << "  udp-pps [batch] [seconds] [window] [host] [port] - PING load on UdpRadioServer, responses/s" << std::endl;
+    std::cout << "  udp-storm [clients] [rate] [seconds] [sockets] [mix h:p:s:e] [host] [group] - virtual radio clients, RTT and loss" << std::endl;
+    std::cout << "  zerocopy [size] [seconds] [host] [port] - copy vs MSG_ZEROCOPY sends, sender CPU per GB" << std::endl;
+    return 1;
+}
@@ -1,4 +1,5 @@
 ﻿#include "../Common/net_utils.h"
+#include "../Common/file_frame.h"
 #include "Client.h"
 #include <string>
 #include <sstream>
@@ -7,20 +8,239 @@
 #include <cctype>
 #include <thread>
 #include <atomic>
+#include <mutex>
+#include <map>
+#include <fstream>
+#include <filesystem>
 
 
 
 std::atomic<bool> running{ true };
 
+// Отправляют и ввод, и потоки загрузки файлов - кадры не должны перемешаться
+std::mutex send_mutex;
+
+bool send_locked(net_utils::socket_t server_socket, const std::string& message) {
+    std::lock_guard<std::mutex> lock(send_mutex);
+    return net_utils::send_message(server_socket, message);
+}
+
+// Передачи файлов: что загружаем, что предложено, что скачиваем
+const char* DOWNLOAD_DIRECTORY = "downloads";
+
+struct Download {
+    std::fstream file;
+    std::string path;
+};
+
+// Передача по номеру: пропуск от сервера нужен для /resume и /getfile
+struct Upload {
+    std::string path;
+    std::string token;
+    bool active = false;    // Поток загрузки уже идёт - повторный FILE UPLOAD не нужен
+};
+
+struct Offer {
+    std::string name;
+    std::string token;
+};
+
+std::mutex files_mutex;
+std::map<std::string, std::string> pending_uploads;    // Имя -> путь, ждут номера от сервера
+std::map<uint32_t, Upload> upload_paths;               // Номер -> путь и пропуск, для /resume
+std::map<uint32_t, Offer> offers;                      // Номер -> имя и пропуск, для /getfile
+std::map<uint32_t, Download> downloads;
+std::vector<std::thread> uploads;
+
+std::vector<std::string> split_words(const std::string& line) {
+    std::istringstream stream(line);
+    std::vector<std::string> words;
+    std::string word;
+    while (stream >> word) words.push_back(word);
+    return words;
+}
+
+// Остаток строки после fields слов (сервер разделяет их одним пробелом) -
+// имя файла идёт последним и может содержать пробелы
+std::string words_tail(const std::string& line, size_t fields) {
+    size_t position = 0;
+    for (size_t i = 0; i < fields && position != std::string::npos; ++i) {
+        position = line.find(' ', position);
+        if (position != std::string::npos) ++position;
+    }
+    return position == std::string::npos ? "" : line.substr(position);
+}
+
+// Загрузка с offset кусками file_frame. Между кусками проходят сообщения чата.
+void upload_chunks(net_utils::socket_t server_socket, uint32_t id, const std::string& path, uint64_t offset) {
+    std::error_code error;
+    uint64_t size = std::filesystem::file_size(path, error);
+    std::ifstream file(path, std::ios::binary);
+    file.seekg((std::streamoff)offset);
+    if (!file || error) {
+        std::cout << "\nCannot read " << path << std::endl;
+        return;
+    }
+
+    char header[file_frame::HEADER_SIZE];
+    std::vector<char> data(file_frame::CHUNK_SIZE);
+    while (running) {
+        file.read(data.data(), (std::streamsize)data.size());
+        size_t read = (size_t)file.gcount();
+        uint8_t flags = offset + read >= size ? file_frame::FLAG_LAST : 0;
+        file_frame::encode_header(header, id, offset, flags);
+
+        int length = (int)(file_frame::HEADER_SIZE + read);
+        net_utils::IoSlice slices[3] = {
+            { reinterpret_cast<const char*>(&length), sizeof(int) },
+            { header, sizeof(header) },
+            { data.data(), read }
+        };
+        {
+            std::lock_guard<std::mutex> lock(send_mutex);
+            if (!net_utils::send_slices_all(server_socket, slices, 3)) return;
+        }
+        offset += read;
+        if (flags & file_frame::FLAG_LAST || read == 0) break;
+    }
+}
+
+void upload_thread(net_utils::socket_t server_socket, uint32_t id, std::string path, uint64_t offset) {
+    upload_chunks(server_socket, id, path, offset);
+    std::lock_guard<std::mutex> lock(files_mutex);
+    upload_paths[id].active = false;
+}
+
+// Служебные ответы сервера о файлах: запускаем загрузку, запоминаем предложения,
+// открываем файл под скачивание
+void on_file_notice(net_utils::socket_t server_socket, const std::string& message) {
+    std::vector<std::string> words = split_words(message);
+    if (words.size() < 6) return;
+    uint32_t id = (uint32_t)std::stoul(words[2]);
+
+    std::lock_guard<std::mutex> lock(files_mutex);
+    if (words[1] == "UPLOAD") {
+        // FILE UPLOAD номер смещение пропуск имя
+        auto pending = pending_uploads.find(words_tail(message, 5));
+        if (!upload_paths.count(id) && pending != pending_uploads.end()) {
+            upload_paths[id].path = pending->second;
+            pending_uploads.erase(pending);
+        }
+        auto upload = upload_paths.find(id);
+        if (upload == upload_paths.end() || upload->second.path.empty()) return;
+        upload->second.token = words[4];
+        if (upload->second.active) return;
+        upload->second.active = true;
+        uploads.emplace_back(upload_thread, server_socket, id, upload->second.path, std::stoull(words[3]));
+    }
+    else if (words[1] == "OFFER" && words.size() >= 7) {
+        // FILE OFFER номер размер пропуск ID_отправителя имя
+        offers[id] = { words_tail(message, 6), words[4] };
+    }
+    else if (words[1] == "BEGIN") {
+        // FILE BEGIN номер размер смещение имя: докачка - дописываем имеющийся файл
+        std::filesystem::create_directory(DOWNLOAD_DIRECTORY);
+        Download& download = downloads[id];
+        download.path = std::string(DOWNLOAD_DIRECTORY) + "/" + words_tail(message, 5);
+        std::ios::openmode mode = std::ios::binary | std::ios::in | std::ios::out;
+        if (std::stoull(words[4]) == 0) mode |= std::ios::trunc;
+        download.file.open(download.path, mode);
+        if (!download.file) download.file.open(download.path, mode | std::ios::trunc);
+    }
+}
+
+// Кусок скачиваемого файла - на диск по смещению, на экран не выводим
+void on_file_chunk(const std::string& message) {
+    file_frame::Chunk chunk;
+    if (!file_frame::decode(message.data(), message.size(), chunk)) return;
+
+    std::lock_guard<std::mutex> lock(files_mutex);
+    auto it = downloads.find(chunk.transfer);
+    if (it == downloads.end()) return;
+    Download& download = it->second;
+    download.file.seekp((std::streamoff)chunk.offset);
+    download.file.write(chunk.data, (std::streamsize)chunk.size);
+
+    if (chunk.flags & file_frame::FLAG_LAST) {
+        download.file.close();
+        std::cout << "\nFile saved: " << download.path << std::endl;
+        std::cout << "> " << std::flush;
+        downloads.erase(it);
+    }
+}
+
+// Команды файлов дополняем на клиенте: путь меняем на размер и имя,
+// к /getfile добавляем размер уже скачанной части. Возвращает, что отправить.
+std::string prepare_file_command(const std::string& input) {
+    std::vector<std::string> words = split_words(input);
+    std::error_code error;
+    if (words.size() == 3 && words[0] == "/sendfile") {
+        // /sendfile получатель путь
+        uint64_t size = std::filesystem::file_size(words[2], error);
+        if (error) {
+            std::cout << "Cannot read " << words[2] << std::endl;
+            return "";
+        }
+        std::string name = std::filesystem::path(words[2]).filename().string();
+        std::lock_guard<std::mutex> lock(files_mutex);
+        pending_uploads[name] = words[2];
+        return "/sendfile " + words[1] + " " + std::to_string(size) + " " + name;
+    }
+    if ((words.size() == 3 || words.size() == 4) && words[0] == "/resume") {
+        // /resume номер [пропуск] путь - после перезапуска клиента пропуск и путь нужно назвать снова
+        std::lock_guard<std::mutex> lock(files_mutex);
+        Upload& upload = upload_paths[(uint32_t)std::stoul(words[1])];
+        if (words.size() == 4) upload.token = words[2];
+        upload.path = words.back();
+        if (upload.token.empty()) {
+            std::cout << "Usage: /resume 'File' 'Token' 'Path' (token is in FILE UPLOAD)" << std::endl;
+            return "";
+        }
+        return "/resume " + words[1] + " " + upload.token;
+    }
+    if ((words.size() == 2 || words.size() == 3) && words[0] == "/getfile") {
+        // /getfile номер [пропуск] + размер уже скачанной части
+        std::lock_guard<std::mutex> lock(files_mutex);
+        Offer& offer = offers[(uint32_t)std::stoul(words[1])];
+        if (words.size() == 3) offer.token = words[2];
+        if (offer.token.empty()) {
+            std::cout << "Usage: /getfile 'File' 'Token' (token is in FILE OFFER)" << std::endl;
+            return "";
+        }
+        std::string command = "/getfile " + words[1] + " " + offer.token;
+        if (!offer.name.empty()) {
+            uint64_t have = std::filesystem::file_size(
+                std::string(DOWNLOAD_DIRECTORY) + "/" + offer.name, error);
+            if (!error && have > 0) command += " " + std::to_string(have);
+        }
+        return command;
+    }
+    return input;
+}
+
 void receive_thread(net_utils::socket_t server_socket) {
+    net_utils::FrameDecoder decoder;
+    std::string message;
     while (running) {
-        std::string message = net_utils::read_message(server_socket);
-        if (message.empty()) {
+        if (decoder.receive(server_socket, message) != net_utils::ReadStatus::Ok) {
             std::cout << "\n Connection lost!" << std::endl;
             running = false;
             break;
         }
 
+        if (file_frame::is_chunk(message.data(), message.size())) {
+            on_file_chunk(message);
+            continue;
+        }
+        if (message.rfind("FILE ", 0) == 0) {
+            try {
+                on_file_notice(server_socket, message);
+            }
+            catch (const std::exception&) {
+                // В FILE ERROR номер может быть любым текстом от пользователя
+            }
+        }
+
         // Выводим сообщение с новой строки
         std::cout << "\n" << message << std::endl;
         std::cout << "> " << std::flush;
@@ -89,8 +309,17 @@ int ClientListener::runClient(const std::string& IP) {
         if (!running) break;
         if (input.empty()) continue;
 
+        // /sendfile, /resume и /getfile дополняются на клиенте
+        try {
+            input = prepare_file_command(input);
+        }
+        catch (const std::exception&) {
+            // Номер передачи не число - пусть сервер ответит подсказкой
+        }
+        if (input.empty()) continue;
+
         // Отправляем сообщение
-        if (!net_utils::send_message(clientSocket, input)) {
+        if (!send_locked(clientSocket, input)) {
             std::cout << "Ошибка отправки сообщения!" << std::endl;
             break;
         }
@@ -103,6 +332,9 @@ int ClientListener::runClient(const std::string& IP) {
     }
     running = false;
     receiver.join();
+    for (std::thread& upload : uploads) {
+        upload.join();
+    }
 
     // Закрываем соединение
     net_utils::shutdown(clientSocket);
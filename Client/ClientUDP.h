@@ -1,12 +1,22 @@
 #pragma once
 #include "../Common/net_utils.h"
+#include "../Common/radio_frame.h"
+#include "GapTracker.h"
 #include <iostream>
 #include <thread>
 #include <atomic>
 #include <chrono>
 #include <vector>
 #include <iomanip>
+#include <mutex>
+#include <random>
 
+struct UdpClientConfig {
+    std::string multicast_group;    //  -   broadcast
+    double loss_rate = 0.0;         //  ,   ()
+    bool binary = false;            //      (  HELLO)
+    bool checksum = false;          //     
+};
 
 class UdpRadioClient {
 private:
@@ -22,14 +32,24 @@ private:
     const int BROADCAST_PORT = 12345;
     const int COMMAND_PORT = 12346;
     int response_port_;
+    sockaddr_in server_addr_;               //   
+    net_utils::UdpBufferPool buffers_{ 2 };  //  :   
+
+    //  :     NACK 
+    UdpClientConfig config_;
+    GapTracker gaps_;
+    std::mutex gaps_mutex_;
 
     // 
     std::atomic<int> received_broadcasts_{ 0 };
     std::atomic<int> received_responses_{ 0 };
     std::atomic<int> sent_commands_{ 0 };
+    std::atomic<int> sent_nacks_{ 0 };
+    std::atomic<int> dropped_broadcasts_{ 0 };
 public:
 
-    UdpRadioClient(const std::string& server_ip = "127.0.0.1");
+    UdpRadioClient(const std::string& server_ip = "127.0.0.1",
+        const UdpClientConfig& config = UdpClientConfig());
     ~UdpRadioClient();
 
     void start();
@@ -39,5 +59,10 @@ private:
     void broadcast_listen_loop();
     void response_listen_loop();
     void input_loop();
+    void send_request(const std::string& input);
     void send_command(const std::string& command);
+    void send_frame(const std::string& input);
+    void print_frame(const char* data, size_t size);
+    void send_nacks(std::vector<GapTracker::Range>& ranges);
+    void print_reliability_stats();
 };
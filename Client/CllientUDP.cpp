@@ -1,24 +1,41 @@
 #include "ClientUDP.h"
 
-UdpRadioClient::UdpRadioClient(const std::string& server_ip)
-        : SERVER_IP(server_ip), response_port_(0) {
+UdpRadioClient::UdpRadioClient(const std::string& server_ip, const UdpClientConfig& config)
+        : SERVER_IP(server_ip), response_port_(0), config_(config) {
 
         if (!net_utils::net_init()) {
             throw std::runtime_error("Network init failed");
         }
 
+        //     ,     
+        if (!net_utils::make_address(SERVER_IP.c_str(), COMMAND_PORT, server_addr_)) {
+            throw std::runtime_error("Wrong server address: " + SERVER_IP);
+        }
+
         //1.     
         broadcast_socket_ = net_utils::create_udp_socket();
         if (broadcast_socket_ == net_utils::INVALID_SOCKET_VAL) {
             throw std::runtime_error("Listen socket creation failed");
         }
 
+        //        
+        if (!config_.multicast_group.empty()) {
+            net_utils::enable_reuse_address(broadcast_socket_);
+        }
+
         //   broadcast 
         if (!net_utils::bind_socket(broadcast_socket_, BROADCAST_PORT)) {
             net_utils::socket_close(broadcast_socket_);
             throw std::runtime_error("Bind failed");
         }
 
+        //   :      
+        if (!config_.multicast_group.empty() &&
+            !net_utils::join_multicast(broadcast_socket_, config_.multicast_group.c_str())) {
+            net_utils::socket_close(broadcast_socket_);
+            throw std::runtime_error("Multicast join failed: " + config_.multicast_group);
+        }
+
         // 2.      
         response_socket_ = net_utils::create_udp_socket();
         if (response_socket_ == net_utils::INVALID_SOCKET_VAL) {
@@ -44,6 +61,10 @@ UdpRadioClient::UdpRadioClient(const std::string& server_ip)
         getsockname(response_socket_, (sockaddr*)&response_addr, &addr_len);
         response_port_ = ntohs(response_addr.sin_port);
 
+        //     :    running_
+        net_utils::set_timeout(broadcast_socket_, 100);
+        net_utils::set_timeout(response_socket_, 100);
+
         //3.     
         command_socket_ = net_utils::create_udp_socket();
         if (command_socket_ == net_utils::INVALID_SOCKET_VAL) {
@@ -52,10 +73,18 @@ UdpRadioClient::UdpRadioClient(const std::string& server_ip)
         }
 
         std::cout << "UDP Radio Client started" << std::endl;
-        std::cout << "Listening broadcast on port: " << BROADCAST_PORT << std::endl;
+        std::cout << "Listening broadcast on port: " << BROADCAST_PORT;
+        if (!config_.multicast_group.empty()) std::cout << " (multicast " << config_.multicast_group << ")";
+        std::cout << std::endl;
         std::cout << "Listening responses on port: " << response_port_ << std::endl;
         std::cout << "Sending commands to: " << SERVER_IP << ":" << COMMAND_PORT << std::endl;
-        std::cout << "Commands: HELLO, STATUS, ECHO <text>, TIME, PING, exit" << std::endl;
+        if (config_.loss_rate > 0) {
+            std::cout << "Injected broadcast loss: " << config_.loss_rate * 100 << "%" << std::endl;
+        }
+        if (config_.binary) {
+            std::cout << "Binary commands" << (config_.checksum ? " with checksum" : "") << std::endl;
+        }
+        std::cout << "Commands: HELLO, STATUS, ECHO <text>, TIME, PING, stats, exit" << std::endl;
     }
 
 UdpRadioClient::~UdpRadioClient() {
@@ -94,16 +123,61 @@ UdpRadioClient::~UdpRadioClient() {
         std::cout << "Received broadcasts: " << received_broadcasts_ << std::endl;
         std::cout << "Received responses: " << received_responses_ << std::endl;
         std::cout << "Sent commands: " << sent_commands_ << std::endl;
+        print_reliability_stats();
     }
 
     //   
     void UdpRadioClient::broadcast_listen_loop() {
         std::cout << "Listening for broadcasts..." << std::endl;
 
+        net_utils::UdpBuffer* packet = buffers_.acquire();
+        std::mt19937 random(std::random_device{}());
+        std::uniform_real_distribution<double> chance(0.0, 1.0);
+        std::vector<GapTracker::Range> nacks;
+
         while (running_) {
-            //    
-            net_utils::UdpPacket packet;
-            if (net_utils::receive_udp_with_timeout(broadcast_socket_, packet, 100)) {
+            //   (    )
+            bool received = net_utils::receive_udp_into(broadcast_socket_, *packet);
+
+            //     -   
+            if (received && config_.loss_rate > 0 && chance(random) < config_.loss_rate) {
+                dropped_broadcasts_++;
+                received = false;
+            }
+
+            const char* text = packet->data;
+            size_t size = packet->size;
+            uint32_t seq = 0;
+            uint8_t flags = 0;
+            char tick_text[160];
+            if (received && net_utils::read_radio_header(text, size, seq, flags)) {
+                text += net_utils::RADIO_HEADER_SIZE;
+                size -= net_utils::RADIO_HEADER_SIZE;
+
+                //   -     ,   
+                radio_frame::Header header;
+                const char* payload;
+                radio_frame::Tick tick;
+                if ((flags & net_utils::RADIO_BINARY) &&
+                    radio_frame::decode(text, size, header, payload) == radio_frame::DecodeStatus::Ok &&
+                    radio_frame::decode_tick(header, payload, tick)) {
+                    time_t tick_time = (time_t)(tick.time_ms / 1000);
+                    struct tm tick_info;
+                    localtime_s(&tick_info, &tick_time);
+                    size = strftime(tick_text, sizeof(tick_text), "[RADIO] Time: %Y-%m-%d %H:%M:%S", &tick_info);
+                    size += snprintf(tick_text + size, sizeof(tick_text) - size,
+                        " | Data: %u | Seq: %u | Clients: %u", tick.data, seq, tick.clients);
+                    text = tick_text;
+                }
+                else if (flags & net_utils::RADIO_BINARY) {
+                    received = false;   //   -  ,  
+                }
+
+                std::lock_guard<std::mutex> lock(gaps_mutex_);
+                if (received) received = gaps_.on_packet(seq, GapTracker::now_ms());  //   
+            }
+
+            if (received) {
                 received_broadcasts_++;
 
                 //     
@@ -113,10 +187,17 @@ UdpRadioClient::~UdpRadioClient() {
                 struct tm time_info;
                 localtime_s(&time_info, &time);
                 std::cout << "\n[" << std::put_time(&time_info, "%H:%M:%S")
-                    << "] BROADCAST: " << packet.data << std::endl;
+                    << "] BROADCAST" << (flags & net_utils::RADIO_RETRANSMIT ? " (retransmit)" : "")
+                    << ": ";
+                std::cout.write(text, size);
+                std::cout << std::endl;
                 std::cout << "> " << std::flush;
             }
+
+            //    -   ,    
+            send_nacks(nacks);
         }
+        buffers_.release(packet);
 
         std::cout << "Broadcast listener stopped" << std::endl;
     }
@@ -124,24 +205,34 @@ UdpRadioClient::~UdpRadioClient() {
     void UdpRadioClient::response_listen_loop() {
         std::cout << "Response listener started on port " << response_port_ << std::endl;
 
+        net_utils::UdpBuffer* packet = buffers_.acquire();
         while (running_) {
-            net_utils::UdpPacket packet;
-            if (net_utils::receive_udp_with_timeout(response_socket_, packet, 100)) {
+            if (net_utils::receive_udp_into(response_socket_, *packet)) {
                 received_responses_++;
 
+                if (packet->size >= radio_frame::HEADER_SIZE &&
+                    radio_frame::get_u16(packet->data) == radio_frame::MAGIC) {
+                    print_frame(packet->data, packet->size);
+                    continue;
+                }
+
                 auto now = std::chrono::system_clock::now();
                 auto time = std::chrono::system_clock::to_time_t(now);
 
                 struct tm time_info;
                 localtime_s(&time_info, &time);
 
+                char address[net_utils::ADDRESS_STRLEN];
                 std::cout << "\n[" << std::put_time(&time_info, "%H:%M:%S")
                     << "] Response #" << received_responses_
-                    << " from " << packet.sender_ip << ":" << packet.sender_port
-                    << ": " << packet.data << std::endl;
+                    << " from " << net_utils::format_address(packet->sender, address, sizeof(address))
+                    << ": ";
+                std::cout.write(packet->data, packet->size);
+                std::cout << std::endl;
                 std::cout << "> " << std::flush;
             }
         }
+        buffers_.release(packet);
 
         std::cout << "Response listener stopped" << std::endl;
     }
@@ -151,7 +242,7 @@ UdpRadioClient::~UdpRadioClient() {
         std::string input;
 
         std::this_thread::sleep_for(std::chrono::milliseconds(500));
-        send_command("HELLO " + std::to_string(response_port_));
+        send_request("HELLO");
 
         while (running_) {
             std::cout << "> ";
@@ -162,24 +253,34 @@ UdpRadioClient::~UdpRadioClient() {
 
             //  
             if (input == "exit") {
-                send_command("GOODBYE " + std::to_string(response_port_));
+                send_request("GOODBYE");
                 std::this_thread::sleep_for(std::chrono::milliseconds(100));
                 stop();
                 break;
             }
 
+            //   - ,   
+            if (input == "stats") {
+                print_reliability_stats();
+                continue;
+            }
+
             //  
-            send_command(input + " " + std::to_string(response_port_));
+            send_request(input);
         }
     }
 
+    //    :        
+    void UdpRadioClient::send_request(const std::string& input) {
+        if (config_.binary) send_frame(input);
+        else send_command(input + " " + std::to_string(response_port_));
+    }
+
     //     
     void UdpRadioClient::send_command(const std::string& command) {
         if (!running_) return;
 
-        net_utils::set_timeout(command_socket_, 1000);
-
-        if (net_utils::send_udp_string(command_socket_, command, SERVER_IP, COMMAND_PORT)) {
+        if (net_utils::send_udp_to(command_socket_, command.data(), command.size(), server_addr_)) {
             sent_commands_++;
             std::cout << "Command sent: " << command << std::endl;
         }
@@ -187,3 +288,107 @@ UdpRadioClient::~UdpRadioClient() {
             std::cerr << "Failed to send command: " << command << std::endl;
         }
     }
+
+    // NACK <first> <last>   :     
+    void UdpRadioClient::send_nacks(std::vector<GapTracker::Range>& ranges) {
+        {
+            std::lock_guard<std::mutex> lock(gaps_mutex_);
+            gaps_.due_nacks(GapTracker::now_ms(), ranges);
+        }
+
+        char nack[64];
+        for (const GapTracker::Range& range : ranges) {
+            int length = snprintf(nack, sizeof(nack), "NACK %u %u", range.first, range.last);
+            if (net_utils::send_udp_to(command_socket_, nack, length, server_addr_)) {
+                sent_nacks_++;
+            }
+        }
+    }
+
+    void UdpRadioClient::print_reliability_stats() {
+        GapTracker::Stats stats;
+        size_t pending;
+        {
+            std::lock_guard<std::mutex> lock(gaps_mutex_);
+            stats = gaps_.stats();
+            pending = gaps_.pending();
+        }
+
+        std::cout << "Broadcast gaps: " << stats.gaps << ", recovered: " << stats.recovered
+            << ", lost: " << stats.lost << ", pending: " << pending
+            << ", duplicates: " << stats.duplicates << ", restarts: " << stats.restarts << std::endl;
+        std::cout << "Recovery latency: mean " << stats.mean_recovery_ms << " ms, max "
+            << stats.max_recovery_ms << " ms" << std::endl;
+        std::cout << "NACKs sent: " << sent_nacks_ << ", dropped on purpose: "
+            << dropped_broadcasts_ << std::endl;
+    }
+
+    // "ECHO text" ->  ECHO  ;   -  
+    void UdpRadioClient::send_frame(const std::string& input) {
+        if (!running_) return;
+
+        size_t name_end = input.find(' ');
+        std::string name = input.substr(0, name_end);
+        uint8_t type = radio_frame::command_type(name.data(), name.size());
+        if (type == 0) {
+            std::cerr << "Unknown command: " << name << std::endl;
+            return;
+        }
+
+        const char* text = name_end == std::string::npos ? nullptr : input.data() + name_end + 1;
+        size_t text_size = text ? input.size() - name_end - 1 : 0;
+        char frame[radio_frame::MAX_FRAME];
+        size_t size = radio_frame::encode_command(frame, type, (uint16_t)response_port_,
+            text, text_size, config_.checksum);
+
+        if (net_utils::send_udp_to(command_socket_, frame, size, server_addr_)) {
+            sent_commands_++;
+            std::cout << "Command sent: " << name << " (binary, " << size << " bytes)" << std::endl;
+        }
+        else {
+            std::cerr << "Failed to send command: " << name << std::endl;
+        }
+    }
+
+    //      
+    void UdpRadioClient::print_frame(const char* data, size_t size) {
+        radio_frame::Header header;
+        const char* payload = nullptr;
+        radio_frame::DecodeStatus status = radio_frame::decode(data, size, header, payload);
+        std::cout << "\nResponse #" << received_responses_ << " (binary): ";
+        if (status != radio_frame::DecodeStatus::Ok) {
+            std::cout << "bad frame: " << radio_frame::status_name(status) << std::endl;
+            std::cout << "> " << std::flush;
+            return;
+        }
+
+        radio_frame::Welcome welcome;
+        radio_frame::Status server_status;
+        uint64_t time_ms;
+        if (radio_frame::decode_welcome(header, payload, welcome)) {
+            std::cout << "WELCOME, protocol v" << (int)welcome.version << ", radio "
+                << (welcome.binary_radio ? "binary" : "text") << ", response port "
+                << welcome.response_port;
+        }
+        else if (radio_frame::decode_status(header, payload, server_status)) {
+            std::cout << "STATUS uptime " << server_status.uptime_s << " s, broadcasts "
+                << server_status.broadcasts << ", retransmits " << server_status.retransmits
+                << ", received " << server_status.received << ", responses " << server_status.responses
+                << ", clients " << server_status.clients;
+        }
+        else if (radio_frame::decode_time(header, payload, time_ms)) {
+            time_t time = (time_t)(time_ms / 1000);
+            struct tm time_info;
+            localtime_s(&time_info, &time);
+            std::cout << "SERVER TIME: " << std::put_time(&time_info, "%Y-%m-%d %H:%M:%S");
+        }
+        else {
+            std::cout << radio_frame::type_name(header.type);
+            if (header.length) {
+                std::cout << ": ";
+                std::cout.write(payload, header.length);
+            }
+        }
+        std::cout << std::endl;
+        std::cout << "> " << std::flush;
+    }
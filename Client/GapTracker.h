@@ -0,0 +1,153 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+//    :     (NACK)
+//     .    .
+class GapTracker {
+public:
+    struct Range {
+        uint32_t first;
+        uint32_t last;
+    };
+
+    struct Stats {
+        uint64_t received = 0;      //  
+        uint64_t duplicates = 0;
+        uint64_t gaps = 0;          // ,  
+        uint64_t recovered = 0;     //   (   )
+        uint64_t lost = 0;          //    
+        uint64_t restarts = 0;      //    ( )
+        double mean_recovery_ms = 0;    //     
+        double max_recovery_ms = 0;
+    };
+
+    static const uint32_t MAX_TRACKED = 1024;   //  -   
+    static const uint32_t MAX_RANGE = 64;       //      NACK
+    static const size_t MAX_RANGES = 8;         //     due_nacks
+    static const int MAX_ATTEMPTS = 5;
+private:
+    struct Missing {
+        uint64_t detected_ms;
+        uint64_t next_nack_ms;
+        int attempts;
+    };
+
+    uint64_t retry_ms_;
+    bool started_ = false;
+    uint32_t highest_ = 0;
+    std::map<uint32_t, Missing> missing_;
+    Stats stats_;
+    double recovery_sum_ms_ = 0;
+public:
+    // retry_ms -    NACK,  
+    explicit GapTracker(uint64_t retry_ms = 50) : retry_ms_(retry_ms) {
+    }
+
+    static uint64_t now_ms() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // false -  ( ,    )
+    bool on_packet(uint32_t seq, uint64_t now_ms) {
+        //     -      .
+        //          .
+        if (started_ && seq < highest_ && highest_ - seq > MAX_TRACKED) {
+            stats_.lost += missing_.size();
+            missing_.clear();
+            started_ = false;
+            ++stats_.restarts;
+        }
+
+        if (!started_) {
+            //   :     
+            started_ = true;
+            highest_ = seq;
+            ++stats_.received;
+            return true;
+        }
+
+        if (seq > highest_) {
+            uint32_t first_missing = highest_ + 1;
+            if (seq - first_missing > MAX_TRACKED) {
+                stats_.gaps += seq - first_missing - MAX_TRACKED;
+                stats_.lost += seq - first_missing - MAX_TRACKED;
+                first_missing = seq - MAX_TRACKED;
+            }
+            for (uint32_t s = first_missing; s < seq; ++s) {
+                missing_[s] = Missing{ now_ms, now_ms, 0 };
+                ++stats_.gaps;
+            }
+            //       
+            while (missing_.size() > MAX_TRACKED) {
+                missing_.erase(missing_.begin());
+                ++stats_.lost;
+            }
+            highest_ = seq;
+            ++stats_.received;
+            return true;
+        }
+
+        auto it = missing_.find(seq);
+        if (it == missing_.end()) {
+            ++stats_.duplicates;
+            return false;
+        }
+
+        double recovery_ms = (double)(now_ms - it->second.detected_ms);
+        recovery_sum_ms_ += recovery_ms;
+        stats_.max_recovery_ms = std::max(stats_.max_recovery_ms, recovery_ms);
+        ++stats_.recovered;
+        ++stats_.received;
+        missing_.erase(it);
+        return true;
+    }
+
+    // ,   (),   .
+    //    ,  MAX_ATTEMPTS   .
+    void due_nacks(uint64_t now_ms, std::vector<Range>& out) {
+        out.clear();
+        for (auto it = missing_.begin(); it != missing_.end();) {
+            Missing& missing = it->second;
+            if (missing.next_nack_ms > now_ms) {
+                ++it;
+                continue;
+            }
+            if (missing.attempts >= MAX_ATTEMPTS) {
+                ++stats_.lost;
+                it = missing_.erase(it);
+                continue;
+            }
+
+            uint32_t seq = it->first;
+            if (!out.empty() && out.back().last + 1 == seq &&
+                out.back().last - out.back().first + 1 < MAX_RANGE) {
+                out.back().last = seq;
+            }
+            else if (out.size() < MAX_RANGES) {
+                out.push_back(Range{ seq, seq });
+            }
+            else {
+                break;  //  -   
+            }
+
+            missing.next_nack_ms = now_ms + (retry_ms_ << missing.attempts);
+            ++missing.attempts;
+            ++it;
+        }
+    }
+
+    size_t pending() const {
+        return missing_.size();
+    }
+
+    Stats stats() const {
+        Stats result = stats_;
+        if (stats_.recovered) result.mean_recovery_ms = recovery_sum_ms_ / stats_.recovered;
+        return result;
+    }
+};
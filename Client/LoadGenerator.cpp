@@ -0,0 +1,410 @@
+#include "LoadGenerator.h"
+#include "../Server/Metrics.h"
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <memory>
+#include <cstdlib>
+#include <stdexcept>
+
+#ifdef NET_LINUX
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#endif
+
+namespace {
+    //   : "LG < , > xxxx..."
+    const char MARKER[] = "LG ";
+    const size_t MAX_OUTBOX = 1024 * 1024;  //  -   ,  
+
+    //  : epoll  Linux, WSAPoll  Windows.
+    //       .
+    class Poller {
+    private:
+        #ifdef NET_LINUX
+        int epoll_fd_;
+        std::vector<epoll_event> events_;
+        #else
+        std::vector<WSAPOLLFD> fds_;
+        #endif
+    public:
+        explicit Poller(size_t capacity) {
+            #ifdef NET_LINUX
+            epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+            if (epoll_fd_ == -1) throw std::runtime_error("epoll_create1 failed");
+            events_.resize(std::max<size_t>(capacity, 1));
+            #else
+            fds_.reserve(capacity);
+            #endif
+        }
+
+        ~Poller() {
+            #ifdef NET_LINUX
+            close(epoll_fd_);
+            #endif
+        }
+
+        Poller(const Poller&) = delete;
+        Poller& operator=(const Poller&) = delete;
+
+        //   : index -  
+        void add(net_utils::socket_t sock, size_t index) {
+            #ifdef NET_LINUX
+            epoll_event ev = {};
+            ev.events = EPOLLIN | EPOLLRDHUP;
+            ev.data.u64 = index;
+            epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, sock, &ev);
+            #else
+            fds_.push_back({ sock, POLLRDNORM, 0 });
+            #endif
+        }
+
+        //  ,    
+        void want_write(net_utils::socket_t sock, size_t index, bool enable) {
+            #ifdef NET_LINUX
+            epoll_event ev = {};
+            ev.events = EPOLLIN | EPOLLRDHUP | (enable ? (uint32_t)EPOLLOUT : 0u);
+            ev.data.u64 = index;
+            epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, sock, &ev);
+            #else
+            fds_[index].events = POLLRDNORM | (enable ? POLLWRNORM : 0);
+            #endif
+        }
+
+        void remove(net_utils::socket_t sock, size_t index) {
+            #ifdef NET_LINUX
+            (void)index;
+            epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, sock, nullptr);
+            #else
+            fds_[index].fd = INVALID_SOCKET;    // WSAPoll   
+            #endif
+        }
+
+        template <typename Handler>
+        void wait(int timeout_ms, Handler&& handler) {
+            #ifdef NET_LINUX
+            int count = epoll_wait(epoll_fd_, events_.data(), (int)events_.size(), timeout_ms);
+            for (int i = 0; i < count; ++i) {
+                uint32_t flags = events_[i].events;
+                handler((size_t)events_[i].data.u64, (flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0,
+                    (flags & EPOLLOUT) != 0);
+            }
+            #else
+            if (fds_.empty() || WSAPoll(fds_.data(), (ULONG)fds_.size(), timeout_ms) <= 0) return;
+            for (size_t i = 0; i < fds_.size(); ++i) {
+                SHORT flags = fds_[i].revents;
+                if (!flags) continue;
+                handler(i, (flags & (POLLRDNORM | POLLHUP | POLLERR)) != 0, (flags & POLLWRNORM) != 0);
+            }
+            #endif
+        }
+    };
+
+    struct LoadConnection {
+        net_utils::socket_t socket;
+        net_utils::FrameDecoder decoder{ net_utils::MAX_FRAME_SIZE, 4096 };
+        std::string outbox;             // ,    
+        size_t out_offset = 0;
+        bool writing = false;           //  EPOLLOUT
+        bool open = true;
+        size_t fanout = 0;              //     
+    };
+
+    struct WorkerStats {
+        long long sent = 0;
+        long long skipped = 0;          //   
+        long long expected = 0;         //    
+        long long delivered = 0;
+        long long received_bytes = 0;
+        long long disconnected = 0;
+    };
+
+    //  :    steady_clock
+    struct Timeline {
+        uint64_t start;                 //   (  )
+        uint64_t end;                   //  
+        uint64_t stop;                  //   
+    };
+
+    class LoadWorker {
+    private:
+        const LoadConfig& config_;
+        const Timeline& timeline_;
+        Histogram& latency_;
+        std::vector<LoadConnection> connections_;
+        std::vector<size_t> senders_;   //   
+        Poller poller_;
+        std::string payload_;
+        WorkerStats stats_;
+    public:
+        LoadWorker(const LoadConfig& config, const Timeline& timeline, Histogram& latency,
+            std::vector<LoadConnection>&& connections, const std::vector<bool>& is_sender)
+            : config_(config), timeline_(timeline), latency_(latency),
+            connections_(std::move(connections)), poller_(connections_.size()) {
+            for (size_t i = 0; i < connections_.size(); ++i) {
+                poller_.add(connections_[i].socket, i);
+                if (is_sender[i]) senders_.push_back(i);
+            }
+        }
+
+        ~LoadWorker() {
+            for (LoadConnection& conn : connections_) {
+                net_utils::socket_close(conn.socket);
+            }
+        }
+
+        const WorkerStats& stats() const { return stats_; }
+
+        //   -  stride-   ,   first
+        void run(size_t first, size_t stride) {
+            //        
+            if (config_.rooms) {
+                for (size_t i = 0; i < connections_.size(); ++i) {
+                    queue_frame(connections_[i], "/join load" +
+                        std::to_string((first + i * stride) % config_.rooms));
+                }
+            }
+
+            //       
+            double interval_ns = senders_.empty() ? 0 : 1e9 / (config_.rate * senders_.size());
+            long long next_index = 0;
+            uint64_t next_ns = timeline_.start;
+
+            while (true) {
+                uint64_t now = Histogram::now_ns();
+                if (now >= timeline_.stop) break;
+
+                while (interval_ns > 0 && next_ns <= now && next_ns < timeline_.end) {
+                    send_timed(connections_[senders_[next_index % senders_.size()]], next_ns);
+                    ++next_index;
+                    next_ns = timeline_.start + (uint64_t)(next_index * interval_ns);
+                }
+
+                uint64_t wake = next_ns < timeline_.end && interval_ns > 0 ? next_ns : timeline_.stop;
+                int timeout_ms = wake > now ? (int)std::min<uint64_t>((wake - now) / 1000000, 10) : 0;
+                poller_.wait(timeout_ms, [this](size_t index, bool readable, bool writable) {
+                    LoadConnection& conn = connections_[index];
+                    if (!conn.open) return;
+                    if (writable) flush(conn, index);
+                    if (readable) read(conn, index);
+                });
+            }
+        }
+    private:
+        void send_timed(LoadConnection& conn, uint64_t scheduled_ns) {
+            if (!conn.open) return;
+            if (conn.outbox.size() - conn.out_offset > MAX_OUTBOX) {
+                ++stats_.skipped;
+                return;
+            }
+
+            //  -  :    
+            payload_ = MARKER + std::to_string(scheduled_ns) + " ";
+            if (payload_.size() < config_.message_size) payload_.append(config_.message_size - payload_.size(), 'x');
+            queue_frame(conn, payload_);
+            ++stats_.sent;
+            stats_.expected += conn.fanout;
+        }
+
+        void queue_frame(LoadConnection& conn, const std::string& message) {
+            int len = (int)message.size();
+            conn.outbox.append(reinterpret_cast<const char*>(&len), sizeof(len));
+            conn.outbox.append(message);
+            if (!conn.writing) flush(conn, (size_t)(&conn - connections_.data()));
+        }
+
+        void flush(LoadConnection& conn, size_t index) {
+            while (conn.out_offset < conn.outbox.size()) {
+                net_utils::IoSlice slice = { conn.outbox.data() + conn.out_offset,
+                    conn.outbox.size() - conn.out_offset };
+                long sent = net_utils::send_slices(conn.socket, &slice, 1, false);
+                if (sent < 0) {
+                    close_connection(conn, index);
+                    return;
+                }
+                if (sent == 0) break;
+                conn.out_offset += (size_t)sent;
+            }
+
+            bool pending = conn.out_offset < conn.outbox.size();
+            if (!pending) {
+                conn.outbox.clear();
+                conn.out_offset = 0;
+            }
+            if (pending != conn.writing) {
+                conn.writing = pending;
+                poller_.want_write(conn.socket, index, pending);
+            }
+        }
+
+        void read(LoadConnection& conn, size_t index) {
+            std::string message;
+            while (true) {
+                net_utils::ReadStatus status = conn.decoder.fill(conn.socket);
+                while (conn.decoder.next_frame(message)) {
+                    stats_.received_bytes += message.size() + net_utils::FrameDecoder::HEADER_SIZE;
+                    on_message(message);
+                }
+                if (status == net_utils::ReadStatus::WouldBlock) return;
+                if (status != net_utils::ReadStatus::Ok || conn.decoder.failed()) {
+                    close_connection(conn, index);
+                    return;
+                }
+            }
+        }
+
+        //    "[] LG <> ..."  "[#] [] LG <> ..."
+        void on_message(const std::string& message) {
+            size_t marker = message.find(MARKER);
+            if (marker == std::string::npos) return;     //    
+
+            uint64_t now = Histogram::now_ns();
+            uint64_t scheduled = strtoull(message.c_str() + marker + sizeof(MARKER) - 1, nullptr, 10);
+            //     ("#N [] LG ...") -  
+            // ,    :    
+            if (scheduled < timeline_.start) return;
+            ++stats_.delivered;
+            latency_.record(now > scheduled ? now - scheduled : 0);
+        }
+
+        void close_connection(LoadConnection& conn, size_t index) {
+            conn.open = false;
+            ++stats_.disconnected;
+            poller_.remove(conn.socket, index);
+        }
+    };
+
+    net_utils::socket_t connect_one(const sockaddr_in& server) {
+        net_utils::socket_t sock = net_utils::create_tcp_socket();
+        if (sock == net_utils::INVALID_SOCKET_VAL) return sock;
+        if (connect(sock, (const sockaddr*)&server, sizeof(server)) == SOCKET_ERROR_VAL) {
+            net_utils::socket_close(sock);
+            return net_utils::INVALID_SOCKET_VAL;
+        }
+        net_utils::set_nonblocking(sock);
+        return sock;
+    }
+
+    double to_us(uint64_t ns) {
+        return ns / 1000.0;
+    }
+}
+
+int run_load(const LoadConfig& config) {
+    size_t threads = std::max<size_t>(1, std::min(config.threads, config.connections));
+    size_t senders = config.senders ? std::min(config.senders, config.connections) : config.connections;
+
+    #ifdef NET_LINUX
+    //  :      
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+    #endif
+
+    if (!net_utils::net_init()) {
+        throw std::runtime_error("Network init failed");
+    }
+
+    sockaddr_in server;
+    if (!net_utils::make_address(config.host.c_str(), config.port, server)) {
+        throw std::runtime_error("Wrong server address: " + config.host);
+    }
+
+    std::cout << "Chat load: " << config.host << ":" << config.port << ", " << config.connections
+        << " connections (" << senders << " senders";
+    if (config.rooms) std::cout << ", " << config.rooms << " rooms";
+    std::cout << "), " << config.rate << " msg/s each, " << config.message_size << " bytes, "
+        << config.duration << " s, " << threads << " threads" << std::endl;
+
+    //     :     
+    std::vector<std::vector<LoadConnection>> parts(threads);
+    std::vector<std::vector<bool>> part_senders(threads);
+    std::vector<size_t> room_sizes(config.rooms ? config.rooms : 1, 0);
+    size_t connected = 0, failed = 0;
+    for (size_t i = 0; i < config.connections; ++i) {
+        net_utils::socket_t sock = connect_one(server);
+        if (sock == net_utils::INVALID_SOCKET_VAL) {
+            ++failed;
+            continue;
+        }
+        //      ,    (. LoadWorker::run)
+        size_t part = i % threads;
+        size_t room = config.rooms ? (part + parts[part].size() * threads) % config.rooms : 0;
+        ++room_sizes[room];
+        parts[part].emplace_back();
+        parts[part].back().socket = sock;
+        parts[part].back().fanout = room;   //   ,  -  
+        part_senders[part].push_back(i < senders);
+        ++connected;
+    }
+    std::cout << "Connected: " << connected << ", failed: " << failed << std::endl;
+    if (connected < 2) {
+        net_utils::net_cleanup();
+        throw std::runtime_error("Need at least two connections");
+    }
+    for (auto& part : parts) {
+        for (LoadConnection& conn : part) conn.fanout = room_sizes[conn.fanout] - 1;
+    }
+
+    //       ,     
+    Timeline timeline;
+    timeline.start = Histogram::now_ns() + (uint64_t)(config.settle * 1e9);
+    timeline.end = timeline.start + (uint64_t)(config.duration * 1e9);
+    timeline.stop = timeline.end + (uint64_t)(config.drain * 1e9);
+
+    Histogram latency;
+    std::vector<std::unique_ptr<LoadWorker>> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back(new LoadWorker(config, timeline, latency, std::move(parts[t]), part_senders[t]));
+    }
+    std::vector<std::thread> loops;
+    for (size_t t = 0; t < threads; ++t) {
+        loops.emplace_back([&, t]() { workers[t]->run(t, threads); });
+    }
+    for (auto& loop : loops) loop.join();
+
+    WorkerStats total;
+    for (const auto& worker : workers) {
+        const WorkerStats& stats = worker->stats();
+        total.sent += stats.sent;
+        total.skipped += stats.skipped;
+        total.expected += stats.expected;
+        total.delivered += stats.delivered;
+        total.received_bytes += stats.received_bytes;
+        total.disconnected += stats.disconnected;
+    }
+    workers.clear();
+    net_utils::net_cleanup();
+
+    Histogram::Snapshot snapshot = latency.snapshot();
+    double seconds = config.duration;
+    long long lost = std::max(0LL, total.expected - total.delivered);
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Sent: " << total.sent << " (" << total.sent / seconds << " msg/s), skipped: "
+        << total.skipped << ", disconnected: " << total.disconnected << std::endl;
+    std::cout << "Delivered: " << total.delivered << " of " << total.expected << " expected (lost "
+        << lost << "), " << total.delivered / seconds << " msg/s, "
+        << total.received_bytes / seconds / (1024 * 1024) << " MB/s" << std::endl;
+    std::cout << "Fan-out latency, us: p50 " << to_us(snapshot.percentile(0.5))
+        << ", p99 " << to_us(snapshot.percentile(0.99))
+        << ", p999 " << to_us(snapshot.percentile(0.999))
+        << ", max " << to_us(snapshot.max) << std::endl;
+
+    //     
+    std::cout << "RESULT connections=" << connected << " senders=" << std::min(senders, connected)
+        << " rooms=" << config.rooms << " rate=" << config.rate << " size=" << config.message_size
+        << " sent=" << total.sent << " delivered=" << total.delivered << " expected=" << total.expected
+        << " send_per_s=" << total.sent / seconds << " deliver_per_s=" << total.delivered / seconds
+        << " p50_us=" << to_us(snapshot.percentile(0.5)) << " p99_us=" << to_us(snapshot.percentile(0.99))
+        << " p999_us=" << to_us(snapshot.percentile(0.999)) << " max_us=" << to_us(snapshot.max)
+        << std::endl;
+
+    return lost == 0 && total.disconnected == 0 ? 0 : 2;
+}
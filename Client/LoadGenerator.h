@@ -0,0 +1,23 @@
+#pragma once
+#include "../Common/net_utils.h"
+#include <string>
+
+//   :       
+struct LoadConfig {
+    std::string host = "127.0.0.1";
+    int port = 12345;
+    size_t connections = 100;
+    size_t senders = 0;             //    (0 - )
+    double rate = 1.0;              //     
+    size_t message_size = 64;       //     (  )
+    double duration = 10.0;         //  
+    double settle = 1.0;            //         
+    double drain = 2.0;             //     
+    size_t rooms = 0;               // 0 -    ,     N 
+    size_t threads = 1;             //     
+};
+
+//  ,       
+//         
+// (     ).  , 0 - .
+int run_load(const LoadConfig& config);
@@ -1,11 +1,57 @@
 #include "Client.h"
 #include "ClientUDP.h"
+#include "LoadGenerator.h"
 
 #include <iostream>
 #include <string>
 #include <Windows.h>
 
-int main() {
+int main(int argc, char* argv[]) {
+    // --multicast=GROUP:    multicast-
+    // --loss=PERCENT:    (   NACK)
+    // --binary, --checksum:   (  )
+    // TCP,  : --load [--host=IP] [--port=N] [--connections=N] [--senders=N] [--rate=MSG_PER_S]
+    // [--size=BYTES] [--duration=S] [--settle=S] [--drain=S] [--rooms=N] [--threads=N]
+    UdpClientConfig config;
+    LoadConfig load;
+    bool load_mode = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--multicast=", 0) == 0) config.multicast_group = arg.substr(12);
+        else if (arg.rfind("--loss=", 0) == 0) config.loss_rate = std::stod(arg.substr(7)) / 100;
+        else if (arg == "--binary") config.binary = true;
+        else if (arg == "--checksum") config.checksum = true;
+        else if (arg == "--load") load_mode = true;
+        else if (arg.rfind("--host=", 0) == 0) load.host = validateIP(arg.substr(7));
+        else if (arg.rfind("--port=", 0) == 0) load.port = std::stoi(arg.substr(7));
+        else if (arg.rfind("--connections=", 0) == 0) load.connections = std::stoul(arg.substr(14));
+        else if (arg.rfind("--senders=", 0) == 0) load.senders = std::stoul(arg.substr(10));
+        else if (arg.rfind("--rate=", 0) == 0) load.rate = std::stod(arg.substr(7));
+        else if (arg.rfind("--size=", 0) == 0) load.message_size = std::stoul(arg.substr(7));
+        else if (arg.rfind("--duration=", 0) == 0) load.duration = std::stod(arg.substr(11));
+        else if (arg.rfind("--settle=", 0) == 0) load.settle = std::stod(arg.substr(9));
+        else if (arg.rfind("--drain=", 0) == 0) load.drain = std::stod(arg.substr(8));
+        else if (arg.rfind("--rooms=", 0) == 0) load.rooms = std::stoul(arg.substr(8));
+        else if (arg.rfind("--threads=", 0) == 0) load.threads = std::stoul(arg.substr(10));
+    }
+
+    #ifdef TCP
+    if (load_mode) {
+        try {
+            return run_load(load);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    #else
+    if (load_mode) {
+        std::cerr << "--load is only available in the TCP client" << std::endl;
+        return 1;
+    }
+    #endif
+
     std::string ip = "localhost";
     std::cout << "Enter an ip of server: ";
     std::getline(std::cin, ip);
@@ -22,7 +68,7 @@ int main() {
     }
     #else
     try {
-        UdpRadioClient client(ip);
+        UdpRadioClient client(ip, config);
         client.start();
     }
     catch (const std::exception& e) {
@@ -0,0 +1,59 @@
+#pragma once
+#include "radio_frame.h"
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+//       ([int ][]), 
+//  :   ,    .  
+//      -     .
+//  little-endian,   radio_frame.
+namespace file_frame {
+    // [1 ][1 'F'][1 ][1 ][4  ][8   ] + 
+    const size_t HEADER_SIZE = 16;
+    const uint8_t FLAG_LAST = 1;            //   
+    const size_t CHUNK_SIZE = 64 * 1024;    //    
+    const size_t MAX_NAME = 255;
+
+    struct Chunk {
+        uint32_t transfer;
+        uint64_t offset;
+        uint8_t flags;
+        const char* data;
+        size_t size;
+    };
+
+    inline bool is_chunk(const char* data, size_t size) {
+        return size >= HEADER_SIZE && data[0] == '\0' && data[1] == 'F';
+    }
+
+    inline void encode_header(char* out, uint32_t transfer, uint64_t offset, uint8_t flags) {
+        out[0] = '\0';
+        out[1] = 'F';
+        out[2] = (char)flags;
+        out[3] = 0;
+        radio_frame::put_u32(out + 4, transfer);
+        radio_frame::put_u64(out + 8, offset);
+    }
+
+    inline bool decode(const char* data, size_t size, Chunk& chunk) {
+        if (!is_chunk(data, size)) return false;
+        chunk.flags = (uint8_t)data[2];
+        chunk.transfer = radio_frame::get_u32(data + 4);
+        chunk.offset = radio_frame::get_u64(data + 8);
+        chunk.data = data + HEADER_SIZE;
+        chunk.size = size - HEADER_SIZE;
+        return true;
+    }
+
+    //    :     
+    inline bool valid_name(const char* name, size_t length) {
+        if (length == 0 || length > MAX_NAME) return false;
+        if ((length == 1 && name[0] == '.') || (length == 2 && name[0] == '.' && name[1] == '.')) return false;
+        for (size_t i = 0; i < length; ++i) {
+            unsigned char c = (unsigned char)name[i];
+            if (c < 0x20 || c == '/' || c == '\\') return false;
+        }
+        return true;
+    }
+}
@@ -14,6 +14,10 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/uio.h>
+#include <linux/errqueue.h>
 #include <cerrno>
 #endif
 
@@ -21,6 +25,10 @@
 #include <string>
 #include <cstring>
 #include <cstdint>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <cstdio>
 
 namespace net_utils {
 // === 2.    ===
@@ -94,6 +102,38 @@ namespace net_utils {
             (const char*)&broadcast, sizeof(broadcast)) == 0;
     }
 
+    //    multicast-:   
+    //         
+    inline bool set_multicast_options(socket_t sock, int ttl, bool loopback) {
+        #ifdef NET_WINDOWS
+        DWORD ttl_value = ttl;
+        DWORD loop_value = loopback ? 1 : 0;
+        #else
+        unsigned char ttl_value = (unsigned char)ttl;
+        unsigned char loop_value = loopback ? 1 : 0;
+        #endif
+        return setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL,
+            (const char*)&ttl_value, sizeof(ttl_value)) == 0 &&
+            setsockopt(sock, IPPROTO_IP, IP_MULTICAST_LOOP,
+                (const char*)&loop_value, sizeof(loop_value)) == 0;
+    }
+
+    //    (    )
+    inline bool join_multicast(socket_t sock, const char* group) {
+        ip_mreq request;
+        memset(&request, 0, sizeof(request));
+        if (inet_pton(AF_INET, group, &request.imr_multiaddr) <= 0) return false;
+        request.imr_interface.s_addr = htonl(INADDR_ANY);
+        return setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP,
+            (const char*)&request, sizeof(request)) == 0;
+    }
+
+    inline bool enable_reuse_address(socket_t sock) {
+        int reuse = 1;
+        return setsockopt(sock, SOL_SOCKET, SO_REUSEADDR,
+            (const char*)&reuse, sizeof(reuse)) == 0;
+    }
+
     inline bool send_udp(socket_t sock, const char* data, size_t size,
         const char* ip, int port) {
         sockaddr_in addr;
@@ -189,38 +229,648 @@ namespace net_utils {
         return bind(sock, (sockaddr*)&addr, sizeof(addr)) == 0;
     }
 
+    const size_t UDP_MAX_PAYLOAD = 65507;   //   UDP 
 
-    inline bool TCPsend(socket_t socket, const std::string& message) {
-        int len = message.length();
-        #ifdef _WIN32
-        send(socket, reinterpret_cast<char*>(&len), sizeof(int), 0);
-        return send(socket, message.c_str(), message.length(), 0);
+    //   sendto   IP  
+    inline bool make_address(const char* ip, int port, sockaddr_in& addr) {
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        return inet_pton(AF_INET, ip, &addr.sin_addr) > 0;
+    }
+
+    //      timeout_ms (false -   )
+    inline bool wait_readable(socket_t sock, int timeout_ms) {
+        #ifdef NET_WINDOWS
+        WSAPOLLFD pfd = { sock, POLLRDNORM, 0 };
+        return WSAPoll(&pfd, 1, timeout_ms) > 0;
         #else
-        write(socket, reinterpret_cast<char*>(&len), sizeof(int));
-        return write(socket, message.c_str(), message.length());
+        pollfd pfd = { sock, POLLIN, 0 };
+        return poll(&pfd, 1, timeout_ms) > 0;
         #endif
     }
+
+    //    :   ,  -   
+    struct UdpBuffer {
+        char* data;
+        size_t capacity;
+        size_t size;
+        sockaddr_in sender;
+    };
+
+    //    :     ,
+    //  / -    
+    class UdpBufferPool {
+    private:
+        std::vector<char> storage_;
+        std::vector<UdpBuffer> buffers_;
+        std::vector<UdpBuffer*> free_;
+        std::mutex mutex_;
+    public:
+        explicit UdpBufferPool(size_t count, size_t buffer_size = UDP_MAX_PAYLOAD)
+            : storage_(count * buffer_size), buffers_(count) {
+            free_.reserve(count);
+            for (size_t i = 0; i < count; ++i) {
+                buffers_[i].data = &storage_[i * buffer_size];
+                buffers_[i].capacity = buffer_size;
+                buffers_[i].size = 0;
+                free_.push_back(&buffers_[i]);
+            }
+        }
+
+        UdpBufferPool(const UdpBufferPool&) = delete;
+        UdpBufferPool& operator=(const UdpBufferPool&) = delete;
+
+        // nullptr -   
+        UdpBuffer* acquire() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (free_.empty()) return nullptr;
+            UdpBuffer* buffer = free_.back();
+            free_.pop_back();
+            return buffer;
+        }
+
+        void release(UdpBuffer* buffer) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_.push_back(buffer);
+        }
+    };
+
+    //    .      (set_timeout).
+    // false -   .
+    inline bool receive_udp_into(socket_t sock, UdpBuffer& buffer) {
+        #ifdef NET_WINDOWS
+        int from_len = sizeof(buffer.sender);
+        int received = recvfrom(sock, buffer.data, (int)buffer.capacity, 0,
+            (sockaddr*)&buffer.sender, &from_len);
+        #else
+        socklen_t from_len = sizeof(buffer.sender);
+        ssize_t received;
+        do {
+            received = recvfrom(sock, buffer.data, buffer.capacity, 0,
+                (sockaddr*)&buffer.sender, &from_len);
+        } while (received < 0 && errno == EINTR);
+        #endif
+
+        if (received < 0) {
+            buffer.size = 0;
+            return false;
+        }
+        buffer.size = (size_t)received;
+        return true;
+    }
+
+    //     (   IP)
+    inline bool send_udp_to(socket_t sock, const char* data, size_t size, const sockaddr_in& target) {
+        #ifdef NET_WINDOWS
+        int sent = sendto(sock, data, (int)size, 0, (const sockaddr*)&target, sizeof(target));
+        #else
+        ssize_t sent = sendto(sock, data, size, 0, (const sockaddr*)&target, sizeof(target));
+        #endif
+        return sent >= 0;
+    }
+
+    const size_t ADDRESS_STRLEN = INET_ADDRSTRLEN + 6;     // "IP:"  
+
+    // "IP:"    -   
+    inline const char* format_address(const sockaddr_in& addr, char* out, size_t size) {
+        char ip_str[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, (void*)&addr.sin_addr, ip_str, sizeof(ip_str));
+        snprintf(out, size, "%s:%d", ip_str, (int)ntohs(addr.sin_port));
+        return out;
+    }
+
+    //   : [2 ][1 ][1 ][4 ],
+    //    .         (NACK).
+    const size_t RADIO_HEADER_SIZE = 8;
+    const uint16_t RADIO_MAGIC = 0x5244;        // "RD"
+    const uint8_t RADIO_RETRANSMIT = 1;         // :    NACK
+    const uint8_t RADIO_BINARY = 2;             // :   radio_frame,   
+
+    inline void write_radio_header(char* out, uint32_t seq, uint8_t flags) {
+        uint16_t magic = htons(RADIO_MAGIC);
+        uint32_t seq_net = htonl(seq);
+        memcpy(out, &magic, 2);
+        out[2] = (char)flags;
+        out[3] = 0;
+        memcpy(out + 4, &seq_net, 4);
+    }
+
+    // false -    (   )
+    inline bool read_radio_header(const char* data, size_t size, uint32_t& seq, uint8_t& flags) {
+        if (size < RADIO_HEADER_SIZE) return false;
+        uint16_t magic;
+        uint32_t seq_net;
+        memcpy(&magic, data, 2);
+        if (ntohs(magic) != RADIO_MAGIC) return false;
+        memcpy(&seq_net, data + 4, 4);
+        flags = (uint8_t)data[2];
+        seq = ntohl(seq_net);
+        return true;
+    }
+
+    //      (recvmmsg).
+    //      ,   .
+    class UdpReceiveBatch {
+    private:
+        std::vector<char> storage_;         //  
+        std::vector<UdpBuffer> packets_;
+        size_t count_ = 0;                  //   receive()
+        #ifdef NET_LINUX
+        std::vector<mmsghdr> headers_;
+        std::vector<iovec> buffers_;
+        #endif
+    public:
+        explicit UdpReceiveBatch(size_t capacity, size_t slot_size = UDP_MAX_PAYLOAD)
+            : storage_((capacity ? capacity : 1) * slot_size),
+            packets_(capacity ? capacity : 1) {
+            for (size_t i = 0; i < packets_.size(); ++i) {
+                packets_[i].data = &storage_[i * slot_size];
+                packets_[i].capacity = slot_size;
+                packets_[i].size = 0;
+            }
+
+            #ifdef NET_LINUX
+            headers_.resize(packets_.size());
+            buffers_.resize(packets_.size());
+            for (size_t i = 0; i < packets_.size(); ++i) {
+                buffers_[i].iov_base = packets_[i].data;
+                buffers_[i].iov_len = slot_size;
+                msghdr& msg = headers_[i].msg_hdr;
+                memset(&msg, 0, sizeof(msg));
+                msg.msg_name = &packets_[i].sender;
+                msg.msg_iov = &buffers_[i];
+                msg.msg_iovlen = 1;
+            }
+            #endif
+        }
+
+        //      timeout_ms,    .
+        //  , 0 - , -1 - .
+        int receive(socket_t sock, int timeout_ms) {
+            count_ = 0;
+            if (!wait_readable(sock, timeout_ms)) return 0;
+
+            #ifdef NET_LINUX
+            for (auto& header : headers_) {
+                header.msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            }
+
+            int received;
+            do {
+                received = recvmmsg(sock, headers_.data(), (unsigned)headers_.size(),
+                    MSG_DONTWAIT, nullptr);
+            } while (received < 0 && errno == EINTR);
+
+            if (received < 0) {
+                return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+            }
+            for (int i = 0; i < received; ++i) {
+                packets_[i].size = headers_[i].msg_len;
+            }
+            count_ = received;
+            #else
+            //  recvmmsg -   ,    - 
+            while (count_ < packets_.size()) {
+                if (count_ > 0 && !wait_readable(sock, 0)) break;
+                if (!receive_udp_into(sock, packets_[count_])) {
+                    if (count_ > 0) break;
+                    return -1;
+                }
+                ++count_;
+            }
+            #endif
+            return (int)count_;
+        }
+
+        size_t count() const { return count_; }
+        size_t capacity() const { return packets_.size(); }
+        const UdpBuffer& packet(size_t i) const { return packets_[i]; }
+    };
+
+    //  ,    (sendmmsg).
+    //   :   add()   .
+    class UdpSendBatch {
+    private:
+        std::vector<std::string> payloads_;
+        std::vector<sockaddr_in> targets_;
+        size_t count_ = 0;
+        #ifdef NET_LINUX
+        std::vector<mmsghdr> headers_;
+        std::vector<iovec> buffers_;
+        #endif
+    public:
+        explicit UdpSendBatch(size_t capacity)
+            : payloads_(capacity ? capacity : 1), targets_(capacity ? capacity : 1) {
+            #ifdef NET_LINUX
+            headers_.resize(payloads_.size());
+            buffers_.resize(payloads_.size());
+            #endif
+        }
+
+        bool full() const { return count_ == payloads_.size(); }
+        size_t count() const { return count_; }
+        size_t capacity() const { return payloads_.size(); }
+
+        //    flush(),  full()
+        void add(const char* data, size_t size, const sockaddr_in& target) {
+            payloads_[count_].assign(data, size);
+            targets_[count_] = target;
+            ++count_;
+        }
+
+        void add(const std::string& data, const sockaddr_in& target) {
+            add(data.data(), data.size(), target);
+        }
+
+        //  .   ;   .
+        // sent_bytes ( ) -     .
+        size_t flush(socket_t sock, size_t* sent_bytes = nullptr) {
+            size_t sent = 0;
+            size_t bytes = 0;
+
+            #ifdef NET_LINUX
+            for (size_t i = 0; i < count_; ++i) {
+                buffers_[i].iov_base = const_cast<char*>(payloads_[i].data());
+                buffers_[i].iov_len = payloads_[i].size();
+                msghdr& msg = headers_[i].msg_hdr;
+                memset(&msg, 0, sizeof(msg));
+                msg.msg_name = &targets_[i];
+                msg.msg_namelen = sizeof(sockaddr_in);
+                msg.msg_iov = &buffers_[i];
+                msg.msg_iovlen = 1;
+            }
+
+            size_t next = 0;
+            while (next < count_) {
+                int result = sendmmsg(sock, &headers_[next], (unsigned)(count_ - next), 0);
+                if (result < 0) {
+                    if (errno == EINTR) continue;
+                    //      -  
+                    ++next;
+                    continue;
+                }
+                for (int i = 0; i < result; ++i) bytes += payloads_[next + i].size();
+                next += result;
+                sent += result;
+            }
+            #else
+            for (size_t i = 0; i < count_; ++i) {
+                int result = sendto(sock, payloads_[i].data(), (int)payloads_[i].size(), 0,
+                    (const sockaddr*)&targets_[i], sizeof(sockaddr_in));
+                if (result >= 0) {
+                    ++sent;
+                    bytes += payloads_[i].size();
+                }
+            }
+            #endif
+
+            if (sent_bytes) *sent_bytes = bytes;
+            count_ = 0;
+            return sent;
+        }
+    };
+
+
+    //     
+    inline bool set_nonblocking(socket_t sock) {
+        #ifdef NET_WINDOWS
+        u_long mode = 1;
+        return ioctlsocket(sock, FIONBIO, &mode) == 0;
+        #else
+        int flags = fcntl(sock, F_GETFL, 0);
+        return flags != -1 && fcntl(sock, F_SETFL, flags | O_NONBLOCK) == 0;
+        #endif
+    }
+
+    //    ( , EINTR,  )
+    inline bool send_all(socket_t socket, const char* data, size_t size) {
+        while (size > 0) {
+            #ifdef NET_WINDOWS
+            int sent = send(socket, data, (int)size, 0);
+            #else
+            ssize_t sent = send(socket, data, size, MSG_NOSIGNAL);
+            #endif
+            if (sent > 0) {
+                data += sent;
+                size -= sent;
+                continue;
+            }
+            #ifdef NET_LINUX
+            if (sent < 0 && errno == EINTR) continue;
+            if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                //    - ,  
+                pollfd pfd = { socket, POLLOUT, 0 };
+                if (poll(&pfd, 1, 1000) > 0) continue;
+            }
+            #endif
+            return false;
+        }
+        return true;
+    }
+
+    //       (writev / WSASend)
+    struct IoSlice {
+        const char* data;
+        size_t size;
+    };
+
+    const size_t MAX_SLICES = 64;   //      
+
+    //      .
+    //   , 0 -    ( wait == false), -1 - .
+    // zerocopy (   *zerocopy) -   MSG_ZEROCOPY;    
+    //   (ENOBUFS) -       .
+    inline long send_slices(socket_t socket, const IoSlice* slices, size_t count, bool wait,
+        bool* zerocopy = nullptr) {
+        if (count > MAX_SLICES) count = MAX_SLICES;
+        while (true) {
+            #ifdef NET_WINDOWS
+            WSABUF buffers[MAX_SLICES];
+            for (size_t i = 0; i < count; ++i) {
+                buffers[i].buf = const_cast<char*>(slices[i].data);
+                buffers[i].len = (ULONG)slices[i].size;
+            }
+            DWORD sent = 0;
+            if (WSASend(socket, buffers, (DWORD)count, &sent, 0, NULL, NULL) == 0) return (long)sent;
+            if (WSAGetLastError() == WSAEWOULDBLOCK && !wait) return 0;
+            #else
+            iovec buffers[MAX_SLICES];
+            for (size_t i = 0; i < count; ++i) {
+                buffers[i].iov_base = const_cast<char*>(slices[i].data);
+                buffers[i].iov_len = slices[i].size;
+            }
+            msghdr msg = {};
+            msg.msg_iov = buffers;
+            msg.msg_iovlen = count;
+            int flags = MSG_NOSIGNAL | (wait ? 0 : MSG_DONTWAIT);
+            #ifdef MSG_ZEROCOPY
+            if (zerocopy && *zerocopy) flags |= MSG_ZEROCOPY;
+            #endif
+            ssize_t sent = sendmsg(socket, &msg, flags);
+            if (sent >= 0) return (long)sent;
+            if (errno == EINTR) continue;
+            if (errno == ENOBUFS && zerocopy && *zerocopy) {
+                *zerocopy = false;
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                if (!wait) return 0;
+                //  ,    -    
+                pollfd pfd = { socket, POLLOUT, 0 };
+                if (poll(&pfd, 1, 1000) > 0) continue;
+            }
+            #endif
+            return -1;
+        }
+    }
+
+    //     ().  slices .
+    inline bool send_slices_all(socket_t socket, IoSlice* slices, size_t count) {
+        while (count > 0) {
+            long sent = send_slices(socket, slices, count, true);
+            if (sent <= 0) return false;
+
+            //  
+            size_t done = (size_t)sent;
+            while (count > 0 && done >= slices->size) {
+                done -= slices->size;
+                ++slices;
+                --count;
+            }
+            if (count > 0) {
+                slices->data += done;
+                slices->size -= done;
+            }
+        }
+        return true;
+    }
+
+    // MSG_ZEROCOPY (Linux 4.14+):      ,   
+    // ,        .  
+    //      ,    .
+    inline bool enable_zerocopy(socket_t socket) {
+        #if defined(NET_LINUX) && defined(SO_ZEROCOPY)
+        int one = 1;
+        return setsockopt(socket, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == 0;
+        #else
+        (void)socket;
+        return false;
+        #endif
+    }
+
+    //     : on_done(first, last, copied)   .
+    // copied -  -   (loopback,   scatter-gather).
+    // false -  .
+    template <typename Handler>
+    bool read_zerocopy_completions(socket_t socket, Handler&& on_done) {
+        #if defined(NET_LINUX) && defined(SO_EE_ORIGIN_ZEROCOPY)
+        while (true) {
+            char control[128];
+            msghdr msg = {};
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            if (recvmsg(socket, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+                if (errno == EINTR) continue;
+                return errno == EAGAIN || errno == EWOULDBLOCK;
+            }
+            for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+                if (cmsg->cmsg_level != SOL_IP || cmsg->cmsg_type != IP_RECVERR) continue;
+                sock_extended_err error;
+                memcpy(&error, CMSG_DATA(cmsg), sizeof(error));
+                if (error.ee_errno != 0 || error.ee_origin != SO_EE_ORIGIN_ZEROCOPY) continue;
+                on_done(error.ee_info, error.ee_data, (error.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0);
+            }
+        }
+        #else
+        (void)socket;
+        (void)on_done;
+        return true;
+        #endif
+    }
+
+    //  TCP- : [int ][]
+    inline std::string make_frame(const std::string& message) {
+        int len = message.length();
+        std::string frame;
+        frame.reserve(sizeof(int) + message.length());
+        frame.append(reinterpret_cast<const char*>(&len), sizeof(int));
+        frame.append(message);
+        return frame;
+    }
+
+    //  ,     
+    using SharedFrame = std::shared_ptr<const std::string>;
+
+    inline SharedFrame make_shared_frame(const std::string& message) {
+        return std::make_shared<const std::string>(make_frame(message));
+    }
+
+    inline bool TCPsend(socket_t socket, const std::string& message) {
+        //    -  
+        int len = message.length();
+        IoSlice slices[2] = {
+            { reinterpret_cast<const char*>(&len), sizeof(int) },
+            { message.data(), message.length() }
+        };
+        return send_slices_all(socket, slices, 2);
+    }
     
+    const size_t MAX_FRAME_SIZE = 4 * 1024 * 1024;   //  -  
+
+    enum class ReadStatus {
+        Ok,             // - 
+        WouldBlock,     //  ,   
+        Closed,         //   
+        Error
+    };
+
+    //  recv    EINTR
+    inline ReadStatus recv_some(socket_t socket, char* data, size_t size, size_t& received) {
+        while (true) {
+            #ifdef NET_WINDOWS
+            int bytes = recv(socket, data, (int)size, 0);
+            if (bytes > 0) { received = bytes; return ReadStatus::Ok; }
+            if (bytes == 0) return ReadStatus::Closed;
+            if (WSAGetLastError() == WSAEWOULDBLOCK) return ReadStatus::WouldBlock;
+            #else
+            ssize_t bytes = recv(socket, data, size, 0);
+            if (bytes > 0) { received = (size_t)bytes; return ReadStatus::Ok; }
+            if (bytes == 0) return ReadStatus::Closed;
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return ReadStatus::WouldBlock;
+            #endif
+            return ReadStatus::Error;
+        }
+    }
+
+    //       [int ][].
+    // fill()    ,  ,   ,
+    // next_frame()       .
+    //    ,    .
+    class FrameDecoder {
+    public:
+        static const size_t HEADER_SIZE = sizeof(int);
+    private:
+
+        std::vector<char> buffer_;
+        size_t begin_ = 0;          //   
+        size_t end_ = 0;            //   
+        size_t initial_capacity_;
+        size_t max_frame_size_;
+        bool failed_ = false;       //      
+
+        size_t available() const { return end_ - begin_; }
+
+        //    needed     
+        void reserve(size_t needed) {
+            if (buffer_.size() - begin_ >= needed) return;
+            compact();
+            if (buffer_.size() < needed) buffer_.resize(needed);
+        }
+
+        void compact() {
+            if (begin_ == 0) return;
+            memmove(buffer_.data(), buffer_.data() + begin_, available());
+            end_ -= begin_;
+            begin_ = 0;
+        }
+    public:
+        explicit FrameDecoder(size_t max_frame_size = MAX_FRAME_SIZE, size_t initial_capacity = 16384)
+            : buffer_(initial_capacity), initial_capacity_(initial_capacity),
+            max_frame_size_(max_frame_size) {}
+
+        bool failed() const { return failed_; }
+
+        //     . false -    ( failed()).
+        bool next_frame(std::string& message) {
+            if (failed_ || available() < HEADER_SIZE) return false;
+
+            int len = 0;
+            memcpy(&len, buffer_.data() + begin_, HEADER_SIZE);
+            if (len < 0 || (size_t)len > max_frame_size_) {
+                failed_ = true;
+                return false;
+            }
+            if (available() - HEADER_SIZE < (size_t)len) {
+                //      -    
+                reserve(HEADER_SIZE + len);
+                return false;
+            }
+
+            message.assign(buffer_.data() + begin_ + HEADER_SIZE, len);
+            begin_ += HEADER_SIZE + len;
+            if (begin_ == end_) {
+                begin_ = end_ = 0;
+                //        
+                if (buffer_.size() > initial_capacity_ * 4) {
+                    buffer_.resize(initial_capacity_);
+                    buffer_.shrink_to_fit();
+                }
+            }
+            return true;
+        }
+
+        //    ,     
+        ReadStatus fill(socket_t socket) {
+            if (end_ == buffer_.size()) {
+                if (begin_ > 0) compact();
+                else buffer_.resize(buffer_.size() * 2);
+            }
+
+            size_t received = 0;
+            ReadStatus status = recv_some(socket, buffer_.data() + end_,
+                buffer_.size() - end_, received);
+            if (status == ReadStatus::Ok) end_ += received;
+            return status;
+        }
+
+        // ,      (io_uring):   
+        void append(const char* data, size_t size) {
+            if (buffer_.size() - end_ < size) {
+                compact();
+                if (buffer_.size() - end_ < size) buffer_.resize(end_ + size);
+            }
+            memcpy(buffer_.data() + end_, data, size);
+            end_ += size;
+        }
+
+        //  :  ,     -  
+        ReadStatus receive(socket_t socket, std::string& message) {
+            while (!next_frame(message)) {
+                if (failed_) return ReadStatus::Error;
+                ReadStatus status = fill(socket);
+                if (status != ReadStatus::Ok) return status;
+            }
+            return ReadStatus::Ok;
+        }
+    };
+
+    //   size    
+    inline bool read_exact(socket_t socket, char* data, size_t size) {
+        while (size > 0) {
+            size_t received = 0;
+            if (recv_some(socket, data, size, received) != ReadStatus::Ok) return false;
+            data += received;
+            size -= received;
+        }
+        return true;
+    }
+
+    //     (  -   ).
+    //       FrameDecoder.
     inline std::string TCPread(socket_t socket) {
         int len = 0;
-        std::string message;
-        int msg_bytes_read = 0;
-        #ifdef _WIN32
-        recv(socket, reinterpret_cast<char*>(&len), sizeof(int), 0);
-        message.resize(len);
-        while (msg_bytes_read < len) {
-            int bytes = recv(socket, &message[msg_bytes_read], len - msg_bytes_read, 0);
-            msg_bytes_read += bytes;
+        if (!read_exact(socket, reinterpret_cast<char*>(&len), sizeof(int)) ||
+            len < 0 || (size_t)len > MAX_FRAME_SIZE) {
+            return std::string();
         }
-        #else
-        read(socket, reinterpret_cast<char*>(&len), sizeof(int));
-        message.resize(len);
-        while (msg_bytes_read < len) {
-            int bytes = read(socket, &message[msg_bytes_read], len - msg_bytes_read);
-            msg_bytes_read += bytes;
+
+        std::string message(len, '\0');
+        if (!read_exact(socket, &message[0], len)) {
+            return std::string();
         }
-        #endif
-        return message;;
+        return message;
     }
 
     inline void TCPshutdown(socket_t socket) {
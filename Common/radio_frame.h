@@ -0,0 +1,305 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+//   :  ,   .
+//   ,  little-endian   .
+//     :    ,
+//  HELLO   .  -   ,  .
+namespace radio_frame {
+    // [2 ][1 ][1 ][1 ][1 ][2  ] + 
+    // + [4 FNV-1a    ],   FLAG_CHECKSUM
+    const uint16_t MAGIC = 0x4652;      // "RF"
+    const uint8_t VERSION = 1;
+    const size_t HEADER_SIZE = 8;
+    const size_t CHECKSUM_SIZE = 4;
+    const uint8_t FLAG_CHECKSUM = 1;
+    const size_t MAX_PAYLOAD = 480;
+    const size_t MAX_FRAME = HEADER_SIZE + MAX_PAYLOAD + CHECKSUM_SIZE;
+
+    enum Type : uint8_t {
+        TICK = 0x01,
+        //  : [2  ] +  ( ECHO)
+        HELLO = 0x10,
+        STATUS = 0x11,
+        ECHO = 0x12,
+        TIME = 0x13,
+        PING = 0x14,
+        GOODBYE = 0x15,
+        //  
+        WELCOME = 0x20,
+        STATUS_REPLY = 0x21,
+        ECHO_REPLY = 0x22,
+        TIME_REPLY = 0x23,
+        PONG = 0x24,
+        BYE = 0x25,
+        ERROR_REPLY = 0x2F
+    };
+
+    enum class DecodeStatus {
+        Ok,
+        NotFrame,       //   -  
+        BadVersion,
+        Truncated,      //     
+        BadChecksum
+    };
+
+    struct Header {
+        uint8_t version;
+        uint8_t type;
+        uint8_t flags;
+        uint16_t length;
+    };
+
+    inline void put_u16(char* out, uint16_t value) {
+        out[0] = (char)(value & 0xFF);
+        out[1] = (char)(value >> 8);
+    }
+
+    inline void put_u32(char* out, uint32_t value) {
+        for (int i = 0; i < 4; ++i) out[i] = (char)((value >> (8 * i)) & 0xFF);
+    }
+
+    inline void put_u64(char* out, uint64_t value) {
+        for (int i = 0; i < 8; ++i) out[i] = (char)((value >> (8 * i)) & 0xFF);
+    }
+
+    inline uint16_t get_u16(const char* in) {
+        const unsigned char* bytes = (const unsigned char*)in;
+        return (uint16_t)(bytes[0] | (bytes[1] << 8));
+    }
+
+    inline uint32_t get_u32(const char* in) {
+        const unsigned char* bytes = (const unsigned char*)in;
+        uint32_t value = 0;
+        for (int i = 3; i >= 0; --i) value = (value << 8) | bytes[i];
+        return value;
+    }
+
+    inline uint64_t get_u64(const char* in) {
+        const unsigned char* bytes = (const unsigned char*)in;
+        uint64_t value = 0;
+        for (int i = 7; i >= 0; --i) value = (value << 8) | bytes[i];
+        return value;
+    }
+
+    inline uint32_t checksum(const char* data, size_t size) {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= (unsigned char)data[i];
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    //     out + HEADER_SIZE:    .
+    //    .
+    inline size_t finish(char* out, uint8_t type, size_t payload_size, bool with_checksum) {
+        put_u16(out, MAGIC);
+        out[2] = (char)VERSION;
+        out[3] = (char)type;
+        out[4] = (char)(with_checksum ? FLAG_CHECKSUM : 0);
+        out[5] = 0;
+        put_u16(out + 6, (uint16_t)payload_size);
+        size_t size = HEADER_SIZE + payload_size;
+        if (with_checksum) {
+            put_u32(out + size, checksum(out, size));
+            size += CHECKSUM_SIZE;
+        }
+        return size;
+    }
+
+    //  ; payload    
+    inline DecodeStatus decode(const char* data, size_t size, Header& header, const char*& payload) {
+        if (size < HEADER_SIZE || get_u16(data) != MAGIC) return DecodeStatus::NotFrame;
+        header.version = (uint8_t)data[2];
+        header.type = (uint8_t)data[3];
+        header.flags = (uint8_t)data[4];
+        header.length = get_u16(data + 6);
+        if (header.version != VERSION) return DecodeStatus::BadVersion;
+
+        size_t expected = HEADER_SIZE + header.length;
+        if (header.flags & FLAG_CHECKSUM) {
+            if (size < expected + CHECKSUM_SIZE) return DecodeStatus::Truncated;
+            if (get_u32(data + expected) != checksum(data, expected)) return DecodeStatus::BadChecksum;
+        }
+        else if (size < expected) {
+            return DecodeStatus::Truncated;
+        }
+        payload = data + HEADER_SIZE;
+        return DecodeStatus::Ok;
+    }
+
+    //   (  NACK -    )
+    struct Tick {
+        uint64_t time_ms;       // Unix- 
+        uint32_t data;
+        uint32_t clients;
+    };
+
+    const size_t TICK_SIZE = 16;
+
+    inline size_t encode_tick(char* out, const Tick& tick, bool with_checksum) {
+        char* payload = out + HEADER_SIZE;
+        put_u64(payload, tick.time_ms);
+        put_u32(payload + 8, tick.data);
+        put_u32(payload + 12, tick.clients);
+        return finish(out, TICK, TICK_SIZE, with_checksum);
+    }
+
+    inline bool decode_tick(const Header& header, const char* payload, Tick& tick) {
+        if (header.type != TICK || header.length < TICK_SIZE) return false;
+        tick.time_ms = get_u64(payload);
+        tick.data = get_u32(payload + 8);
+        tick.clients = get_u32(payload + 12);
+        return true;
+    }
+
+    //  :      (ECHO)
+    struct Command {
+        uint8_t type;
+        uint16_t response_port;     // 0 -    
+        const char* text;
+        size_t text_size;
+    };
+
+    inline size_t encode_command(char* out, uint8_t type, uint16_t response_port,
+        const char* text, size_t text_size, bool with_checksum) {
+        if (text_size > MAX_PAYLOAD - 2) text_size = MAX_PAYLOAD - 2;
+        put_u16(out + HEADER_SIZE, response_port);
+        if (text_size) memcpy(out + HEADER_SIZE + 2, text, text_size);
+        return finish(out, type, 2 + text_size, with_checksum);
+    }
+
+    inline bool decode_command(const Header& header, const char* payload, Command& command) {
+        if (header.type < HELLO || header.type > GOODBYE || header.length < 2) return false;
+        command.type = header.type;
+        command.response_port = get_u16(payload);
+        command.text = payload + 2;
+        command.text_size = header.length - 2;
+        return true;
+    }
+
+    //     (ECHO_REPLY, ERROR_REPLY)   (PONG, BYE)
+    inline size_t encode_bytes(char* out, uint8_t type, const char* data, size_t size, bool with_checksum) {
+        if (size > MAX_PAYLOAD) size = MAX_PAYLOAD;
+        if (size) memcpy(out + HEADER_SIZE, data, size);
+        return finish(out, type, size, with_checksum);
+    }
+
+    // WELCOME:  ,   ,  
+    struct Welcome {
+        uint8_t version;
+        bool binary_radio;
+        uint16_t response_port;
+    };
+
+    const size_t WELCOME_SIZE = 4;
+
+    inline size_t encode_welcome(char* out, const Welcome& welcome, bool with_checksum) {
+        char* payload = out + HEADER_SIZE;
+        payload[0] = (char)welcome.version;
+        payload[1] = (char)(welcome.binary_radio ? 1 : 0);
+        put_u16(payload + 2, welcome.response_port);
+        return finish(out, WELCOME, WELCOME_SIZE, with_checksum);
+    }
+
+    inline bool decode_welcome(const Header& header, const char* payload, Welcome& welcome) {
+        if (header.type != WELCOME || header.length < WELCOME_SIZE) return false;
+        welcome.version = (uint8_t)payload[0];
+        welcome.binary_radio = payload[1] != 0;
+        welcome.response_port = get_u16(payload + 2);
+        return true;
+    }
+
+    struct Status {
+        uint64_t uptime_s;
+        uint64_t broadcasts;
+        uint64_t retransmits;
+        uint64_t received;
+        uint64_t responses;
+        uint32_t clients;
+    };
+
+    const size_t STATUS_SIZE = 44;
+
+    inline size_t encode_status(char* out, const Status& status, bool with_checksum) {
+        char* payload = out + HEADER_SIZE;
+        put_u64(payload, status.uptime_s);
+        put_u64(payload + 8, status.broadcasts);
+        put_u64(payload + 16, status.retransmits);
+        put_u64(payload + 24, status.received);
+        put_u64(payload + 32, status.responses);
+        put_u32(payload + 40, status.clients);
+        return finish(out, STATUS_REPLY, STATUS_SIZE, with_checksum);
+    }
+
+    inline bool decode_status(const Header& header, const char* payload, Status& status) {
+        if (header.type != STATUS_REPLY || header.length < STATUS_SIZE) return false;
+        status.uptime_s = get_u64(payload);
+        status.broadcasts = get_u64(payload + 8);
+        status.retransmits = get_u64(payload + 16);
+        status.received = get_u64(payload + 24);
+        status.responses = get_u64(payload + 32);
+        status.clients = get_u32(payload + 40);
+        return true;
+    }
+
+    // TIME_REPLY: Unix-   
+    inline size_t encode_time(char* out, uint64_t time_ms, bool with_checksum) {
+        put_u64(out + HEADER_SIZE, time_ms);
+        return finish(out, TIME_REPLY, 8, with_checksum);
+    }
+
+    inline bool decode_time(const Header& header, const char* payload, uint64_t& time_ms) {
+        if (header.type != TIME_REPLY || header.length < 8) return false;
+        time_ms = get_u64(payload);
+        return true;
+    }
+
+    inline const char* status_name(DecodeStatus status) {
+        switch (status) {
+        case DecodeStatus::Ok: return "ok";
+        case DecodeStatus::NotFrame: return "not a frame";
+        case DecodeStatus::BadVersion: return "unsupported version";
+        case DecodeStatus::Truncated: return "truncated frame";
+        case DecodeStatus::BadChecksum: return "bad checksum";
+        default: return "unknown";
+        }
+    }
+
+    inline const char* type_name(uint8_t type) {
+        switch (type) {
+        case TICK: return "TICK";
+        case HELLO: return "HELLO";
+        case STATUS: return "STATUS";
+        case ECHO: return "ECHO";
+        case TIME: return "TIME";
+        case PING: return "PING";
+        case GOODBYE: return "GOODBYE";
+        case WELCOME: return "WELCOME";
+        case STATUS_REPLY: return "STATUS_REPLY";
+        case ECHO_REPLY: return "ECHO_REPLY";
+        case TIME_REPLY: return "TIME_REPLY";
+        case PONG: return "PONG";
+        case BYE: return "BYE";
+        case ERROR_REPLY: return "ERROR";
+        default: return "UNKNOWN";
+        }
+    }
+
+    //    ->   (0 -   )
+    inline uint8_t command_type(const char* name, size_t length) {
+        static const struct { const char* name; uint8_t type; } commands[] = {
+            { "HELLO", HELLO }, { "STATUS", STATUS }, { "ECHO", ECHO },
+            { "TIME", TIME }, { "PING", PING }, { "GOODBYE", GOODBYE }
+        };
+        for (const auto& command : commands) {
+            if (strlen(command.name) == length && memcmp(command.name, name, length) == 0) {
+                return command.type;
+            }
+        }
+        return 0;
+    }
+}
@@ -0,0 +1,487 @@
+#pragma once
+#include "../Common/net_utils.h"
+#include "OutboundQueue.h"
+#include "Rcu.h"
+#include "RoomRouter.h"
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <deque>
+#include <algorithm>
+
+struct StoredFile;
+
+//  (),   .
+//        .
+class ClientShard {
+public:
+    virtual ~ClientShard() = default;
+    virtual void post_broadcast(const net_utils::SharedFrame& frame, int exclude_id) = 0;
+    virtual void post_to_client(int client_id, const net_utils::SharedFrame& frame) = 0;
+    virtual void post_overflow_policy(int client_id, OverflowPolicy policy) = 0;
+    //   ,    
+    virtual void post_to_members(const net_utils::SharedFrame& frame,
+        const RoomRouter::MemberList& members, int exclude_id) = 0;
+    //  announce,      offset    .
+    // false -     (   ).
+    virtual bool post_file(int, const net_utils::SharedFrame&, const std::shared_ptr<StoredFile>&, uint64_t) {
+        return false;
+    }
+};
+
+//  ,   .
+//   :   ,  - 
+//         RCU-.
+//  ,       .
+//     ; ID =     ,
+//   ID        .
+class ClientManager {
+private:
+    struct Client {
+        net_utils::socket_t socket;            //  
+        struct sockaddr_in address; //  
+        std::string name;           //  
+        int id;                     //  ID
+        bool connected;             //  
+        int shard;                  //   (-1 -   )
+        std::shared_ptr<QueuedWriter> writer;   //   (  )
+        std::vector<std::string> rooms;     // ,    
+        std::string room;                   //   ( -  )
+    };
+
+    //        -    
+    static const size_t CHUNK_SIZE = 1024;
+    static const size_t MAX_CHUNKS = 4096;      //  ~4   
+    static const int SLOT_BITS = 22;            // CHUNK_SIZE * MAX_CHUNKS = 2^22
+    static const int SLOT_MASK = (1 << SLOT_BITS) - 1;
+    static const int GENERATION_MASK = 0x1FF;   //  -  9   int
+
+    struct Chunk {
+        std::atomic<const Client*> slots[CHUNK_SIZE];
+        Chunk() {
+            for (auto& slot : slots) slot = nullptr;
+        }
+    };
+
+    std::atomic<Chunk*> chunks_[MAX_CHUNKS];
+    std::atomic<int> max_slot_{ 0 };           //    - 
+    std::atomic<size_t> client_count_{ 0 };
+    std::mutex write_mutex_;                    //   
+    RcuDomain rcu_;
+    int next_slot_ = 1;                         //     ( write_mutex_)
+    std::deque<int> free_ids_;                  //  ID  ,  
+
+    static int slot_of(int client_id) {
+        return client_id & SLOT_MASK;
+    }
+
+    //       ,   
+    std::vector<ClientShard*> shards_;
+    QueueLimits queue_limits_;              //     
+    RoomRouter rooms_;                      //  -> 
+
+    std::atomic<const Client*>* find_slot(int client_id) {
+        if (client_id <= 0) return nullptr;
+        int slot = slot_of(client_id);
+        Chunk* chunk = chunks_[slot / CHUNK_SIZE].load();
+        return chunk ? &chunk->slots[slot % CHUNK_SIZE] : nullptr;
+    }
+
+    //   ReadGuard (  write_mutex_).       .
+    const Client* find(int client_id) {
+        std::atomic<const Client*>* slot = find_slot(client_id);
+        const Client* client = slot ? slot->load() : nullptr;
+        return client && client->id == client_id ? client : nullptr;
+    }
+
+    //      -    
+    const Client* at_slot(int slot) {
+        Chunk* chunk = chunks_[slot / CHUNK_SIZE].load();
+        return chunk ? chunk->slots[slot % CHUNK_SIZE].load() : nullptr;
+    }
+
+    //    (  write_mutex_)
+    void publish(std::atomic<const Client*>& slot, const Client* client) {
+        const Client* old = slot.exchange(client);
+        if (old) {
+            rcu_.synchronize();
+            delete old;
+        }
+    }
+
+    //      
+    template <typename Change>
+    bool update_client(int client_id, Change change) {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        std::atomic<const Client*>* slot = find_slot(client_id);
+        const Client* old = slot ? slot->load() : nullptr;
+        if (!old || old->id != client_id) return false;
+
+        Client* copy = new Client(*old);
+        change(*copy);
+        publish(*slot, copy);
+        return true;
+    }
+public:
+    ClientManager() {
+        for (auto& chunk : chunks_) chunk = nullptr;
+    }
+
+    ~ClientManager() {
+        for (auto& chunk : chunks_) {
+            Chunk* c = chunk.load();
+            if (!c) continue;
+            for (auto& slot : c->slots) delete slot.load();
+            delete c;
+        }
+    }
+
+    void attach_shards(const std::vector<ClientShard*>& shards) {
+        shards_ = shards;
+        rooms_.set_shard_count(shards.size());
+    }
+
+    void set_queue_limits(const QueueLimits& limits) {
+        queue_limits_ = limits;
+    }
+
+    const QueueLimits& queue_limits() const {
+        return queue_limits_;
+    }
+
+    // 0 -  ,   
+    int add_client(net_utils::socket_t socket, struct sockaddr_in address, int shard = -1) {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        int new_id;
+        bool table_full = (size_t)next_slot_ >= CHUNK_SIZE * MAX_CHUNKS;
+        if (!free_ids_.empty() && (free_ids_.size() >= CHUNK_SIZE || table_full)) {
+            //    :  ID  
+            new_id = free_ids_.front();
+            free_ids_.pop_front();
+        }
+        else if (!table_full) {
+            new_id = next_slot_++;
+        }
+        else {
+            return 0;
+        }
+
+        int slot = slot_of(new_id);
+        if (!chunks_[slot / CHUNK_SIZE].load()) {
+            chunks_[slot / CHUNK_SIZE] = new Chunk;
+        }
+
+        Client* new_client = new Client;
+        new_client->socket = socket;
+        new_client->address = address;
+        new_client->name = "User" + std::to_string(new_id);
+        new_client->id = new_id;
+        new_client->connected = true;
+        new_client->shard = shard;
+        if (shard < 0) {
+            new_client->writer = std::make_shared<QueuedWriter>(socket, queue_limits_);
+        }
+
+        chunks_[slot / CHUNK_SIZE].load()->slots[slot % CHUNK_SIZE] = new_client;
+        if (slot > max_slot_) max_slot_ = slot;
+        ++client_count_;
+        return new_id;
+    }
+
+    //  
+    void remove_client(int client_id) {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        std::atomic<const Client*>* slot = find_slot(client_id);
+        const Client* client = slot ? slot->load() : nullptr;
+        if (client && client->id == client_id) {
+            for (const std::string& room : client->rooms) {
+                rooms_.leave(room, client_id, std::max(client->shard, 0));
+            }
+            publish(*slot, nullptr);
+            --client_count_;
+
+            //  -   ,   
+            int generation = ((client_id >> SLOT_BITS) + 1) & GENERATION_MASK;
+            int next_id = (generation << SLOT_BITS) | slot_of(client_id);
+            free_ids_.push_back(next_id);
+        }
+    }
+
+    //   (   )
+    void disconnect_client(int client_id) {
+        std::shared_ptr<QueuedWriter> writer;
+        update_client(client_id, [&writer](Client& client) {
+            client.connected = false;
+            writer = std::move(client.writer);
+        });
+
+        //    : join  
+        if (writer) {
+            writer->close();
+        }
+    }
+
+    //      
+    void set_overflow_policy(int client_id, OverflowPolicy policy) {
+        ClientShard* shard = nullptr;
+        {
+            RcuDomain::ReadGuard guard(rcu_);
+            const Client* client = find(client_id);
+            if (!client) return;
+
+            if (client->writer) {
+                client->writer->set_policy(policy);
+                return;
+            }
+            if (client->shard >= 0) {
+                shard = shards_[client->shard];
+            }
+        }
+
+        //          -
+        //     
+        if (shard) {
+            shard->post_overflow_policy(client_id, policy);
+        }
+    }
+
+    //   
+    std::string get_client_name(int client_id) {
+        RcuDomain::ReadGuard guard(rcu_);
+        const Client* client = find(client_id);
+        if (client) {
+            return client->name;
+        }
+        return "Unknown";
+    }
+
+    //   
+    void set_client_name(int client_id, const std::string& name) {
+        update_client(client_id, [&name](Client& client) {
+            client.name = name;
+        });
+    }
+
+    //   
+    net_utils::socket_t get_client_socket(int client_id) {
+        RcuDomain::ReadGuard guard(rcu_);
+        const Client* client = find(client_id);
+        if (client) {
+            return client->socket;
+        }
+        return net_utils::INVALID_SOCKET_VAL;
+    }
+
+    //    
+    bool is_client_connected(int client_id) {
+        RcuDomain::ReadGuard guard(rcu_);
+        const Client* client = find(client_id);
+        return client && client->connected;
+    }
+
+    //     
+    std::vector<int> get_connected_clients() {
+        RcuDomain::ReadGuard guard(rcu_);
+        std::vector<int> result;
+
+        //   :     ,    ID
+        int max_slot = max_slot_;
+        for (int slot = 1; slot <= max_slot; ++slot) {
+            const Client* client = at_slot(slot);
+            if (client && client->connected) {
+                result.push_back(client->id);
+            }
+        }
+
+        return result;
+    }
+
+    //   
+    size_t get_client_count() {
+        return client_count_;
+    }
+
+    //       . false -  
+    bool join_room(int client_id, const std::string& room) {
+        int shard;
+        {
+            RcuDomain::ReadGuard guard(rcu_);
+            const Client* client = find(client_id);
+            if (!client || !client->connected) return false;
+            shard = std::max(client->shard, 0);
+        }
+
+        bool joined = rooms_.join(room, client_id, shard);
+        return update_client(client_id, [&](Client& client) {
+            if (joined) client.rooms.push_back(room);
+            client.room = room;
+        });
+    }
+
+    //   . false -     
+    bool leave_room(int client_id, const std::string& room) {
+        int shard;
+        {
+            RcuDomain::ReadGuard guard(rcu_);
+            const Client* client = find(client_id);
+            if (!client) return false;
+            shard = std::max(client->shard, 0);
+        }
+
+        if (!rooms_.leave(room, client_id, shard)) return false;
+        update_client(client_id, [&room](Client& client) {
+            client.rooms.erase(std::remove(client.rooms.begin(), client.rooms.end(), room),
+                client.rooms.end());
+            if (client.room == room) client.room.clear();
+        });
+        return true;
+    }
+
+    //    ( -  )
+    std::string get_client_room(int client_id) {
+        RcuDomain::ReadGuard guard(rcu_);
+        const Client* client = find(client_id);
+        return client ? client->room : std::string();
+    }
+
+    std::vector<std::string> get_client_rooms(int client_id) {
+        RcuDomain::ReadGuard guard(rcu_);
+        const Client* client = find(client_id);
+        return client ? client->rooms : std::vector<std::string>();
+    }
+
+    size_t get_room_size(const std::string& room) {
+        return rooms_.room_size(room);
+    }
+
+    size_t get_room_count() const {
+        return rooms_.room_count();
+    }
+
+    //   :       
+    void room_message(const std::string& room, const std::string& message, int exclude_id = -1) {
+        std::vector<RoomRouter::MemberList> members = rooms_.members(room);
+        if (members.empty()) return;
+
+        net_utils::SharedFrame frame = net_utils::make_shared_frame(message);
+
+        //   -   
+        if (!shards_.empty()) {
+            for (size_t i = 0; i < members.size() && i < shards_.size(); ++i) {
+                if (members[i] && !members[i]->empty()) {
+                    shards_[i]->post_to_members(frame, members[i], exclude_id);
+                }
+            }
+            return;
+        }
+
+        std::vector<int> overflowed;
+        {
+            RcuDomain::ReadGuard guard(rcu_);
+            for (const RoomRouter::MemberList& list : members) {
+                if (!list) continue;
+                for (int id : *list) {
+                    const Client* client = find(id);
+                    if (!client || id == exclude_id) continue;
+                    if (!client->connected || !client->writer) continue;
+
+                    if (!client->writer->post(frame)) {
+                        overflowed.push_back(id);
+                    }
+                }
+            }
+        }
+
+        for (int id : overflowed) {
+            disconnect_client(id);
+        }
+    }
+
+    void broadcast_message(const std::string& message, int exclude_id = -1) {
+        //    ,     
+        net_utils::SharedFrame frame = net_utils::make_shared_frame(message);
+
+        // :    ,      
+        if (!shards_.empty()) {
+            for (ClientShard* shard : shards_) {
+                shard->post_broadcast(frame, exclude_id);
+            }
+            return;
+        }
+
+        std::vector<int> overflowed;
+        {
+            RcuDomain::ReadGuard guard(rcu_);
+
+            int max_slot = max_slot_;
+            for (int slot = 1; slot <= max_slot; ++slot) {
+                const Client* client = at_slot(slot);
+
+                //      
+                if (!client || client->id == exclude_id) continue;
+                if (!client->connected || !client->writer) continue;
+
+                //    
+                if (!client->writer->post(frame)) {
+                    overflowed.push_back(client->id);
+                }
+            }
+        }
+
+        //  -    ,    
+        for (int id : overflowed) {
+            disconnect_client(id);
+        }
+    }
+
+    bool send_to_client(int client_id, const std::string& message) {
+        return send_frame(client_id, net_utils::make_shared_frame(message));
+    }
+
+    //   (  ,    ) -  
+    bool send_frame(int client_id, const net_utils::SharedFrame& frame) {
+        ClientShard* shard = nullptr;
+        {
+            RcuDomain::ReadGuard guard(rcu_);
+            const Client* client = find(client_id);
+            if (!client || !client->connected) return false;
+
+            if (client->shard < 0) {
+                if (client->writer && client->writer->post(frame)) {
+                    return true;
+                }
+            }
+            else {
+                shard = shards_[client->shard];
+            }
+        }
+
+        if (shard) {
+            shard->post_to_client(client_id, frame);
+            return true;
+        }
+
+        //   ( Disconnect) - 
+        disconnect_client(client_id);
+        return false;
+    }
+
+    //     ,     .
+    // false -       ;     .
+    bool send_file(int client_id, const std::string& announce, const std::shared_ptr<StoredFile>& file,
+        uint64_t offset) {
+        ClientShard* shard = nullptr;
+        {
+            RcuDomain::ReadGuard guard(rcu_);
+            const Client* client = find(client_id);
+            if (!client || !client->connected || client->shard < 0) return false;
+            shard = shards_[client->shard];
+        }
+        return shard->post_file(client_id, net_utils::make_shared_frame(announce), file, offset);
+    }
+};
+
+//    TCP- (  Server.cpp)
+extern ClientManager client_manager;
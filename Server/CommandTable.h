@@ -0,0 +1,110 @@
+#pragma once
+#include <string_view>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+// :    (     )
+template <typename Handler>
+struct CommandEntry {
+    std::string_view name;
+    Handler handler;
+};
+
+//     ,   .
+//    ,       :
+//  -      ,     .
+template <typename Handler, size_t N>
+class CommandTable {
+private:
+    static_assert(N > 0 && N < 255, "command count must fit a slot index");
+
+    static constexpr size_t round_up(size_t n) {
+        size_t power = 1;
+        while (power < n) power <<= 1;
+        return power;
+    }
+
+    //    :      
+    static constexpr size_t SLOTS = round_up(N * 4);
+    static constexpr uint32_t MAX_SEED = 100000;
+
+    std::array<CommandEntry<Handler>, N> entries_{};
+    std::array<uint8_t, SLOTS> slots_{};    //   + 1, 0 - 
+    uint32_t seed_ = 0;
+
+    static constexpr uint32_t hash(std::string_view name, uint32_t seed) {
+        uint32_t value = 2166136261u ^ (seed * 0x9E3779B9u);
+        for (char c : name) {
+            value ^= (unsigned char)c;
+            value *= 16777619u;
+        }
+        return value ^ (value >> 15);
+    }
+
+    constexpr bool try_seed(uint32_t seed) {
+        for (size_t slot = 0; slot < SLOTS; ++slot) slots_[slot] = 0;
+        for (size_t i = 0; i < N; ++i) {
+            size_t slot = hash(entries_[i].name, seed) & (SLOTS - 1);
+            if (slots_[slot]) return false;
+            slots_[slot] = (uint8_t)(i + 1);
+        }
+        return true;
+    }
+public:
+    constexpr explicit CommandTable(const CommandEntry<Handler>(&entries)[N]) {
+        for (size_t i = 0; i < N; ++i) {
+            for (size_t j = 0; j < i; ++j) {
+                //   throw -      
+                if (entries[i].name == entries[j].name) throw "duplicate command name";
+            }
+            entries_[i] = entries[i];
+        }
+        for (uint32_t seed = 1; seed < MAX_SEED; ++seed) {
+            if (try_seed(seed)) {
+                seed_ = seed;
+                return;
+            }
+        }
+        throw "no perfect hash seed for command names";
+    }
+
+    //    ; size() -   
+    constexpr size_t index_of(std::string_view name) const {
+        uint8_t index = slots_[hash(name, seed_) & (SLOTS - 1)];
+        if (index == 0 || entries_[index - 1].name != name) return N;
+        return index - 1;
+    }
+
+    // nullptr -   
+    constexpr const Handler* find(std::string_view name) const {
+        size_t index = index_of(name);
+        return index < N ? &entries_[index].handler : nullptr;
+    }
+
+    constexpr const CommandEntry<Handler>& entry(size_t index) const {
+        return entries_[index];
+    }
+
+    static constexpr size_t size() {
+        return N;
+    }
+};
+
+//     : make_command_table<Handler>({ {"a", f}, ... })
+template <typename Handler, size_t N>
+constexpr CommandTable<Handler, N> make_command_table(const CommandEntry<Handler>(&entries)[N]) {
+    return CommandTable<Handler, N>(entries);
+}
+
+// " " ->        ,  
+struct ParsedCommand {
+    std::string_view name;
+    std::string_view args;
+};
+
+constexpr ParsedCommand parse_command(std::string_view text) {
+    size_t space = text.find(' ');
+    if (space == std::string_view::npos) return ParsedCommand{ text, std::string_view() };
+    return ParsedCommand{ text.substr(0, space), text.substr(space + 1) };
+}
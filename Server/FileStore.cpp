@@ -0,0 +1,199 @@
+#include "FileStore.h"
+#include "../Common/net_utils.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <sys/stat.h>
+#ifdef NET_WINDOWS
+#include <direct.h>
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+static uint64_t now_ms() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//  : 64    hex
+static std::string make_token(std::mt19937& random) {
+    char token[17];
+    snprintf(token, sizeof(token), "%08x%08x", (unsigned)random(), (unsigned)random());
+    return token;
+}
+
+//    -   
+static bool is_transfer_name(const std::string& name) {
+    if (name.empty()) return false;
+    for (char c : name) {
+        if (c < '0' || c > '9') return false;
+    }
+    return true;
+}
+
+StoredFile::~StoredFile() {
+    //  :  ,     
+    #ifdef NET_WINDOWS
+    if (fd >= 0) _close(fd);
+    #else
+    if (fd >= 0) close(fd);
+    #endif
+    if (!path.empty()) std::remove(path.c_str());
+}
+
+bool FileStore::configure(const std::string& directory, const FileLimits& limits) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    directory_ = directory;
+    limits_ = limits;
+
+    std::error_code code;
+    std::filesystem::create_directories(directory, code);
+    if (!std::filesystem::is_directory(directory, code)) return false;
+
+    //       -    
+    for (const auto& item : std::filesystem::directory_iterator(directory, code)) {
+        if (item.is_regular_file(code) && is_transfer_name(item.path().filename().string())) {
+            std::filesystem::remove(item.path(), code);
+        }
+    }
+    return true;
+}
+
+void FileStore::erase(std::unordered_map<uint32_t, std::shared_ptr<StoredFile>>::iterator it) {
+    //    ,      
+    total_bytes_ -= it->second->size;
+    files_.erase(it);
+}
+
+void FileStore::expire(uint64_t now) {
+    if (limits_.ttl_ms == 0) return;
+    for (auto it = files_.begin(); it != files_.end();) {
+        if (now - it->second->created_ms >= limits_.ttl_ms) {
+            auto expired = it++;
+            erase(expired);
+        } else {
+            ++it;
+        }
+    }
+}
+
+std::shared_ptr<StoredFile> FileStore::create(int owner, int recipient, const std::string& name,
+    uint64_t size, std::string& error) {
+    if (!file_frame::valid_name(name.data(), name.size())) {
+        error = "wrong file name";
+        return nullptr;
+    }
+    if (size > limits_.max_size) {
+        error = "file is larger than " + std::to_string(limits_.max_size) + " bytes";
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t now = now_ms();
+    expire(now);
+
+    size_t owner_files = 0;
+    uint64_t owner_bytes = 0;
+    for (const auto& item : files_) {
+        if (item.second->owner != owner) continue;
+        ++owner_files;
+        owner_bytes += item.second->size;
+    }
+    if (owner_files >= limits_.max_owner_files) {
+        error = "too many files waiting, limit is " + std::to_string(limits_.max_owner_files);
+        return nullptr;
+    }
+    if (size > limits_.max_owner_bytes - owner_bytes) {
+        error = "upload quota exceeded, limit is " + std::to_string(limits_.max_owner_bytes) + " bytes";
+        return nullptr;
+    }
+    if (size > limits_.max_total_bytes - total_bytes_) {
+        error = "server storage is full";
+        return nullptr;
+    }
+
+    //  :        
+    uint32_t id;
+    do {
+        id = random_();
+    } while (id == 0 || files_.count(id));
+
+    std::shared_ptr<StoredFile> file = std::make_shared<StoredFile>();
+    file->id = id;
+    file->name = name;
+    file->size = size;
+    file->created_ms = now;
+    file->upload_token = make_token(random_);
+    file->download_token = make_token(random_);
+    file->owner = owner;
+    file->recipient = recipient;
+
+    std::string path = directory_ + "/" + std::to_string(id);
+    #ifdef NET_WINDOWS
+    file->fd = _open(path.c_str(), _O_RDWR | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+    #else
+    file->fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    #endif
+    if (file->fd < 0) {
+        error = "cannot create file on server";
+        return nullptr;
+    }
+    file->path = path;
+
+    files_[id] = file;
+    total_bytes_ += size;
+    return file;
+}
+
+std::shared_ptr<StoredFile> FileStore::find(uint32_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    expire(now_ms());
+    auto it = files_.find(id);
+    return it != files_.end() ? it->second : nullptr;
+}
+
+FileStore::WriteStatus FileStore::write(const file_frame::Chunk& chunk, int client_id,
+    std::shared_ptr<StoredFile>& file) {
+    file = find(chunk.transfer);
+    if (!file) return WriteStatus::Unknown;
+    if (file->owner != client_id) return WriteStatus::Denied;
+
+    std::lock_guard<std::mutex> lock(file->write_mutex);
+    //    (,  -   ): 
+    //           
+    if (file->complete()) return WriteStatus::Written;
+    uint64_t stored = file->stored.load();
+    if (chunk.offset != stored || chunk.size > file->size - stored) {
+        return WriteStatus::WrongOffset;
+    }
+
+    //     -     
+    const char* data = chunk.data;
+    size_t left = chunk.size;
+    uint64_t offset = chunk.offset;
+    while (left > 0) {
+        #ifdef NET_WINDOWS
+        if (_lseeki64(file->fd, (__int64)offset, SEEK_SET) < 0) return WriteStatus::Failed;
+        int written = _write(file->fd, data, (unsigned)left);
+        #else
+        ssize_t written = pwrite(file->fd, data, left, (off_t)offset);
+        if (written < 0 && errno == EINTR) continue;
+        #endif
+        if (written <= 0) return WriteStatus::Failed;
+        data += written;
+        left -= (size_t)written;
+        offset += (uint64_t)written;
+    }
+
+    file->stored.store(offset);
+    return offset == file->size ? WriteStatus::Complete : WriteStatus::Written;
+}
+
+void FileStore::downloaded(const StoredFile& file, int client_id) {
+    //        -    
+    if (client_id != file.recipient) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = files_.find(file.id);
+    if (it != files_.end() && it->second.get() == &file) erase(it);
+}
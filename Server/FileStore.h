@@ -0,0 +1,100 @@
+#pragma once
+#include "../Common/file_frame.h"
+#include "Metrics.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+//    .  ,     
+// (,  );      .
+struct StoredFile {
+    uint32_t id;                    //    /resume  /getfile
+    std::string name;               //    ( )
+    std::string path;               //    
+    uint64_t size;                  //  
+    uint64_t created_ms;            //   
+    //  -   : ID    ,
+    //         
+    std::string upload_token;       //  /resume   
+    std::string download_token;     //  /getfile
+    std::atomic<int> owner{ 0 };    //   (,  upload_token)
+    std::atomic<int> recipient{ 0 };    //   (   download_token)
+    int fd = -1;
+    std::atomic<uint64_t> stored{ 0 };  //      
+    std::mutex write_mutex;
+
+    bool complete() const { return stored.load() == size; }
+    ~StoredFile();
+};
+
+//   ( ):   ,   
+struct DownloadMetrics {
+    Counter& bytes = MetricsRegistry::instance().counter("chat_file_bytes_total",
+        "File bytes moved by /sendfile transfers", "direction=\"download\"");
+    Counter& files = MetricsRegistry::instance().counter("chat_files_total",
+        "Files handled by /sendfile transfers", "event=\"served\"");
+
+    static DownloadMetrics& get() {
+        static DownloadMetrics metrics;
+        return metrics;
+    }
+};
+
+//  :    /sendfile     
+struct FileLimits {
+    uint64_t max_size = 1ull << 30;             //  
+    uint64_t ttl_ms = 60 * 60 * 1000;           //    
+    size_t max_owner_files = 8;                 //    
+    uint64_t max_owner_bytes = 2ull << 30;      //    
+    uint64_t max_total_bytes = 8ull << 30;      //  
+};
+
+//  :   ,     (  
+//    ).    ,   
+//    stored -    ,  .  
+//  ,        .
+// .
+class FileStore {
+public:
+    enum class WriteStatus {
+        Written,
+        Complete,       //    
+        WrongOffset,    //     -     stored
+        Unknown,        //   
+        Denied,         //       
+        Failed          //  
+    };
+private:
+    std::string directory_;
+    FileLimits limits_;
+    std::mutex mutex_;
+    std::unordered_map<uint32_t, std::shared_ptr<StoredFile>> files_;
+    uint64_t total_bytes_ = 0;      //    
+    std::mt19937 random_{ std::random_device{}() };
+
+    //  mutex_
+    void erase(std::unordered_map<uint32_t, std::shared_ptr<StoredFile>>::iterator it);
+    void expire(uint64_t now_ms);
+public:
+    //  ,   ,    .
+    // false -  .
+    bool configure(const std::string& directory, const FileLimits& limits);
+
+    // nullptr - error  
+    std::shared_ptr<StoredFile> create(int owner, int recipient, const std::string& name,
+        uint64_t size, std::string& error);
+    std::shared_ptr<StoredFile> find(uint32_t id);
+
+    //     client_id; file - ,  
+    WriteStatus write(const file_frame::Chunk& chunk, int client_id, std::shared_ptr<StoredFile>& file);
+
+    // client_id    :     
+    void downloaded(const StoredFile& file, int client_id);
+};
+
+//     (  Server.cpp)
+extern FileStore file_store;
@@ -0,0 +1,443 @@
+#include "HistoryLog.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#ifdef NET_LINUX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+struct HistoryMetrics {
+    Counter& appended = MetricsRegistry::instance().counter("chat_history_messages_total",
+        "Messages written to or replayed from the history log", "event=\"appended\"");
+    Counter& replayed = MetricsRegistry::instance().counter("chat_history_messages_total",
+        "Messages written to or replayed from the history log", "event=\"replayed\"");
+    Gauge& bytes = MetricsRegistry::instance().gauge("chat_history_bytes",
+        "Bytes of messages kept in history segments");
+    Gauge& segments = MetricsRegistry::instance().gauge("chat_history_segments",
+        "History segment files on disk");
+
+    static HistoryMetrics& get() {
+        static HistoryMetrics metrics;
+        return metrics;
+    }
+};
+
+// :      .   - ,
+//    -   .
+struct HistoryLog::Segment {
+    uint64_t first_seq = 0;
+    uint64_t count = 0;         //   
+    size_t used = 0;            //    
+    size_t capacity = 0;
+    char* data = nullptr;
+    uint64_t last_time_ms = 0;  //    (  -  )
+    std::vector<IndexEntry> index;
+    #ifdef NET_WINDOWS
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+    #else
+    int fd = -1;
+    #endif
+
+    ~Segment() {
+        #ifdef NET_WINDOWS
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        #else
+        if (data) munmap(data, capacity);
+        if (fd >= 0) close(fd);
+        #endif
+    }
+
+    //    ; 0 -   
+    size_t frame_at(size_t offset) const {
+        if (offset + sizeof(int) > capacity) return 0;
+        int length;
+        memcpy(&length, data + offset, sizeof(length));
+        if (length <= 0 || (size_t)length > capacity - offset - sizeof(int)) return 0;
+        return sizeof(int) + (size_t)length;
+    }
+};
+
+static uint64_t wall_clock_ms() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+HistoryLog::HistoryLog() = default;
+
+HistoryLog::~HistoryLog() {
+    if (writer_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            stopping_ = true;
+        }
+        pending_ready_.notify_one();
+        writer_.join();
+    }
+    //      ,  
+    if (!segments_.empty()) save_index(*segments_.back());
+}
+
+std::string HistoryLog::segment_path(uint64_t first_seq, const char* extension) const {
+    //     :    
+    char name[32];
+    snprintf(name, sizeof(name), "%020llu", (unsigned long long)first_seq);
+    return config_.directory + "/" + name + extension;
+}
+
+HistoryLog::Segment* HistoryLog::open_segment(uint64_t first_seq, bool create) {
+    std::unique_ptr<Segment> segment(new Segment());
+    segment->first_seq = first_seq;
+    std::string path = segment_path(first_seq, ".log");
+
+    #ifdef NET_WINDOWS
+    segment->file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+        create ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (segment->file == INVALID_HANDLE_VALUE) return nullptr;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(segment->file, &size)) return nullptr;
+    segment->capacity = create || size.QuadPart == 0 ? config_.segment_size : (size_t)size.QuadPart;
+    //      
+    uint64_t capacity = segment->capacity;
+    segment->mapping = CreateFileMappingA(segment->file, nullptr, PAGE_READWRITE,
+        (DWORD)(capacity >> 32), (DWORD)capacity, nullptr);
+    if (!segment->mapping) return nullptr;
+    segment->data = (char*)MapViewOfFile(segment->mapping, FILE_MAP_ALL_ACCESS, 0, 0, segment->capacity);
+    if (!segment->data) return nullptr;
+    #else
+    segment->fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC | (create ? O_CREAT | O_TRUNC : 0), 0644);
+    if (segment->fd < 0) return nullptr;
+    struct stat info;
+    if (fstat(segment->fd, &info) != 0) return nullptr;
+    segment->capacity = create || info.st_size == 0 ? config_.segment_size : (size_t)info.st_size;
+    //    :       
+    if ((size_t)info.st_size != segment->capacity && ftruncate(segment->fd, (off_t)segment->capacity) != 0) {
+        return nullptr;
+    }
+    void* data = mmap(nullptr, segment->capacity, PROT_READ | PROT_WRITE, MAP_SHARED, segment->fd, 0);
+    if (data == MAP_FAILED) return nullptr;
+    segment->data = (char*)data;
+    #endif
+
+    if (!create) recover(*segment);
+
+    segments_.push_back(std::move(segment));
+    HistoryMetrics::get().segments.add(1);
+    return segments_.back().get();
+}
+
+//    :       
+//  .    ,     .
+void HistoryLog::recover(Segment& segment) {
+    std::string index_path = segment_path(segment.first_seq, ".idx");
+    if (FILE* file = fopen(index_path.c_str(), "rb")) {
+        IndexEntry entry;
+        while (fread(&entry, sizeof(entry), 1, file) == 1) {
+            uint64_t expected = segment.first_seq + segment.index.size() * INDEX_INTERVAL;
+            bool ordered = segment.index.empty() || entry.offset > segment.index.back().offset;
+            if (entry.seq != expected || !ordered || !segment.frame_at((size_t)entry.offset)) break;
+            segment.index.push_back(entry);
+        }
+        fclose(file);
+    }
+
+    if (!segment.index.empty()) {
+        segment.used = (size_t)segment.index.back().offset;
+        segment.count = segment.index.back().seq - segment.first_seq;
+        segment.last_time_ms = segment.index.back().time_ms;
+    }
+    //     -    
+    while (size_t frame = segment.frame_at(segment.used)) {
+        if (segment.count % INDEX_INTERVAL == 0 && segment.count / INDEX_INTERVAL >= segment.index.size()) {
+            segment.index.push_back({ segment.first_seq + segment.count, segment.used, segment.last_time_ms });
+        }
+        segment.used += frame;
+        ++segment.count;
+    }
+
+    //      
+    save_index(segment);
+}
+
+//   :      
+void HistoryLog::save_index(const Segment& segment) const {
+    if (FILE* file = fopen(segment_path(segment.first_seq, ".idx").c_str(), "wb")) {
+        if (!segment.index.empty()) {
+            fwrite(segment.index.data(), sizeof(IndexEntry), segment.index.size(), file);
+        }
+        fclose(file);
+    }
+}
+
+bool HistoryLog::open(const HistoryConfig& config, std::string& error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+    if (config_.directory.empty()) return false;
+
+    std::error_code code;
+    std::filesystem::create_directories(config_.directory, code);
+    std::vector<uint64_t> found;
+    for (const auto& item : std::filesystem::directory_iterator(config_.directory, code)) {
+        std::string name = item.path().filename().string();
+        if (name.size() == 24 && name.compare(20, 4, ".log") == 0 &&
+            std::all_of(name.begin(), name.begin() + 20, ::isdigit)) {
+            found.push_back(std::stoull(name.substr(0, 20)));
+        }
+    }
+    if (code) {
+        error = "cannot read " + config_.directory + ": " + code.message();
+        config_.directory.clear();
+        return false;
+    }
+    std::sort(found.begin(), found.end());
+
+    for (uint64_t first_seq : found) {
+        Segment* segment = open_segment(first_seq, false);
+        if (!segment) {
+            error = "cannot map " + segment_path(first_seq, ".log");
+            segments_.clear();
+            config_.directory.clear();
+            return false;
+        }
+        total_bytes_ += segment->used;
+        HistoryMetrics::get().bytes.add((int64_t)segment->used);
+    }
+    {
+        std::lock_guard<std::mutex> pending_lock(pending_mutex_);
+        if (!segments_.empty()) next_seq_ = segments_.back()->first_seq + segments_.back()->count;
+        if (next_seq_ == 0) next_seq_ = 1;
+    }
+    enforce_retention(wall_clock_ms());
+
+    enabled_.store(true, std::memory_order_release);
+    writer_ = std::thread(&HistoryLog::writer_loop, this);
+    return true;
+}
+
+bool HistoryLog::enabled() const {
+    return enabled_.load(std::memory_order_acquire);
+}
+
+void HistoryLog::rotate(uint64_t first_seq, uint64_t time_ms) {
+    //   (,   )  
+    if (!segments_.empty() && segments_.back()->count == 0) {
+        std::unique_ptr<Segment>& empty = segments_.back();
+        std::string log_path = segment_path(empty->first_seq, ".log");
+        std::string index_path = segment_path(empty->first_seq, ".idx");
+        empty.reset();
+        segments_.pop_back();
+        HistoryMetrics::get().segments.add(-1);
+        std::remove(log_path.c_str());
+        std::remove(index_path.c_str());
+    }
+    else if (!segments_.empty()) {
+        save_index(*segments_.back());
+    }
+    open_segment(first_seq, true);
+    enforce_retention(time_ms);
+}
+
+void HistoryLog::enforce_retention(uint64_t time_ms) {
+    //    ,      
+    while (segments_.size() > 1) {
+        Segment& oldest = *segments_.front();
+        bool too_big = total_bytes_ > config_.retain_bytes;
+        bool too_old = config_.retain_ms && time_ms > oldest.last_time_ms + config_.retain_ms;
+        if (!too_big && !too_old) break;
+
+        std::string log_path = segment_path(oldest.first_seq, ".log");
+        std::string index_path = segment_path(oldest.first_seq, ".idx");
+        total_bytes_ -= oldest.used;
+        HistoryMetrics::get().bytes.add(-(int64_t)oldest.used);
+        HistoryMetrics::get().segments.add(-1);
+        segments_.pop_front();
+        std::remove(log_path.c_str());
+        std::remove(index_path.c_str());
+    }
+}
+
+uint64_t HistoryLog::append(const std::string& message) {
+    if (!enabled() || message.empty() ||
+        sizeof(int) + MAX_PREFIX + message.size() > config_.segment_size) return 0;
+
+    //        
+    Pending item{ 0, message };
+    uint64_t seq;
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        seq = item.seq = next_seq_++;
+        wake = pending_.empty();
+        pending_.push_back(std::move(item));
+    }
+    if (wake) pending_ready_.notify_one();
+    return seq;
+}
+
+std::string HistoryLog::numbered(uint64_t seq, const std::string& message) {
+    return "#" + std::to_string(seq) + " " + message;
+}
+
+//  :      
+void HistoryLog::writer_loop() {
+    std::vector<Pending> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> pending_lock(pending_mutex_);
+            pending_ready_.wait(pending_lock, [this] { return stopping_ || !pending_.empty(); });
+            if (pending_.empty()) break;
+        }
+
+        //    mutex_:      ,   
+        std::lock_guard<std::mutex> lock(mutex_);
+        {
+            std::lock_guard<std::mutex> pending_lock(pending_mutex_);
+            batch.swap(pending_);
+        }
+        uint64_t now = wall_clock_ms();
+        for (const Pending& item : batch) {
+            if (!enabled()) break;
+            if (!write(item, now)) {
+                //       -   
+                LOG_ERROR("History is off: cannot write message #%llu to %s",
+                    (unsigned long long)item.seq, config_.directory.c_str());
+                enabled_.store(false, std::memory_order_release);
+            }
+        }
+        batch.clear();
+    }
+}
+
+//  mutex_,    
+bool HistoryLog::write(const Pending& item, uint64_t time_ms) {
+    std::string text = numbered(item.seq, item.message);
+    size_t frame = sizeof(int) + text.size();
+    if (segments_.empty() || segments_.back()->used + frame > segments_.back()->capacity) {
+        rotate(item.seq, time_ms);
+        if (segments_.empty() || segments_.back()->used + frame > segments_.back()->capacity) return false;
+    }
+    else {
+        enforce_retention(time_ms);
+    }
+
+    Segment& segment = *segments_.back();
+    char* at = segment.data + segment.used;
+    //   :       
+    int length = (int)text.size();
+    memcpy(at + sizeof(int), text.data(), text.size());
+    memcpy(at, &length, sizeof(length));
+
+    if (segment.count % INDEX_INTERVAL == 0) {
+        segment.index.push_back({ item.seq, segment.used, time_ms });
+    }
+    segment.used += frame;
+    ++segment.count;
+    segment.last_time_ms = time_ms;
+    total_bytes_ += frame;
+
+    HistoryMetrics& metrics = HistoryMetrics::get();
+    metrics.appended.add();
+    metrics.bytes.add((int64_t)frame);
+    return true;
+}
+
+//   seq:     -   INDEX_INTERVAL 
+size_t HistoryLog::find_offset(const Segment& segment, uint64_t seq) const {
+    auto entry = std::upper_bound(segment.index.begin(), segment.index.end(), seq,
+        [](uint64_t value, const IndexEntry& item) { return value < item.seq; });
+    if (entry == segment.index.begin()) return 0;
+    --entry;
+
+    size_t offset = (size_t)entry->offset;
+    for (uint64_t current = entry->seq; current < seq; ++current) {
+        offset += segment.frame_at(offset);
+    }
+    return offset;
+}
+
+uint64_t HistoryLog::replay_since(uint64_t seq, size_t limit, std::vector<net_utils::SharedFrame>& blocks) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (limit == 0) return seq;
+
+    uint64_t last = seq;
+    size_t replayed = 0;
+    uint64_t start = segments_.empty() ? seq + 1 : std::max(seq + 1, segments_.front()->first_seq);
+    uint64_t written_end = segments_.empty() ? 0 : segments_.back()->first_seq + segments_.back()->count;
+
+    //     
+    auto it = segments_.end();
+    if (start < written_end) {
+        it = std::upper_bound(segments_.begin(), segments_.end(), start,
+            [](uint64_t value, const std::unique_ptr<Segment>& item) { return value < item->first_seq; });
+        --it;
+    }
+    for (; it != segments_.end() && replayed < limit; ++it) {
+        const Segment& segment = **it;
+        uint64_t current = std::max(start, segment.first_seq);
+        size_t offset = find_offset(segment, current);
+        size_t block_start = offset;
+
+        //    -    
+        while (current < segment.first_seq + segment.count && replayed < limit) {
+            size_t frame = segment.frame_at(offset);
+            if (!frame) break;
+            if (offset + frame - block_start > REPLAY_BLOCK && offset > block_start) {
+                blocks.push_back(std::make_shared<const std::string>(segment.data + block_start,
+                    offset - block_start));
+                block_start = offset;
+            }
+            offset += frame;
+            last = current++;
+            ++replayed;
+        }
+        if (offset > block_start) {
+            blocks.push_back(std::make_shared<const std::string>(segment.data + block_start,
+                offset - block_start));
+        }
+    }
+
+    // ,     -    
+    if (replayed < limit) {
+        std::lock_guard<std::mutex> pending_lock(pending_mutex_);
+        std::string block;
+        for (const Pending& item : pending_) {
+            if (replayed >= limit) break;
+            if (item.seq < start) continue;
+            std::string frame = net_utils::make_frame(numbered(item.seq, item.message));
+            if (block.size() + frame.size() > REPLAY_BLOCK && !block.empty()) {
+                blocks.push_back(std::make_shared<const std::string>(std::move(block)));
+                block.clear();
+            }
+            block += frame;
+            last = item.seq;
+            ++replayed;
+        }
+        if (!block.empty()) {
+            blocks.push_back(std::make_shared<const std::string>(std::move(block)));
+        }
+    }
+
+    HistoryMetrics::get().replayed.add(replayed);
+    return last;
+}
+
+uint64_t HistoryLog::first_seq() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!segments_.empty()) return segments_.front()->first_seq;
+    std::lock_guard<std::mutex> pending_lock(pending_mutex_);
+    return pending_.empty() ? next_seq_ : pending_.front().seq;
+}
+
+uint64_t HistoryLog::last_seq() const {
+    std::lock_guard<std::mutex> pending_lock(pending_mutex_);
+    return next_seq_ - 1;
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include "../Common/net_utils.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct HistoryConfig {
+    std::string directory;                  //  -    ( --history=DIR)
+    size_t segment_size = 16 * 1024 * 1024; //   
+    uint64_t retain_bytes = 256ull * 1024 * 1024;   //  -   
+    uint64_t retain_ms = 0;                 //  -  (0 -    )
+    size_t replay_count = 20;               //     
+};
+
+//   :  ,   -,
+//   .     ([int ]["#seq "]) -
+//  ,    ,   -     
+// ,   ,       /since.
+//   (seq)   -    ;  
+// ( INDEX_INTERVAL- : , , )   
+//     .idx      -  
+//     .
+// append()        :   
+//  ,     ,     .
+// .
+class HistoryLog {
+public:
+    static const size_t INDEX_INTERVAL = 64;
+    static const size_t REPLAY_BLOCK = 64 * 1024;   //     , 
+    static const size_t MAX_PREFIX = 22;            // "#" +  20  + 
+
+    struct IndexEntry {
+        uint64_t seq;
+        uint64_t offset;
+        uint64_t time_ms;
+    };
+private:
+    struct Segment;
+
+    //   ,     
+    struct Pending {
+        uint64_t seq;
+        std::string message;
+    };
+
+    HistoryConfig config_;              //  open()  
+    std::atomic<bool> enabled_{ false };
+
+    // :   ,  
+    mutable std::mutex mutex_;
+    std::deque<std::unique_ptr<Segment>> segments_;
+    uint64_t total_bytes_ = 0;
+
+    //   .  : mutex_,  pending_mutex_.
+    mutable std::mutex pending_mutex_;
+    std::condition_variable pending_ready_;
+    std::vector<Pending> pending_;
+    uint64_t next_seq_ = 1;
+    bool stopping_ = false;
+    std::thread writer_;
+
+    std::string segment_path(uint64_t first_seq, const char* extension) const;
+    Segment* open_segment(uint64_t first_seq, bool create);
+    void recover(Segment& segment);
+    void save_index(const Segment& segment) const;
+    void rotate(uint64_t first_seq, uint64_t time_ms);
+    void enforce_retention(uint64_t time_ms);
+    bool write(const Pending& item, uint64_t time_ms);
+    void writer_loop();
+    size_t find_offset(const Segment& segment, uint64_t seq) const;
+public:
+    HistoryLog();
+    ~HistoryLog();
+
+    //    . false -   (error - ).
+    bool open(const HistoryConfig& config, std::string& error);
+    bool enabled() const;
+
+    //    ;    (0 -  ).
+    //     ,     .
+    uint64_t append(const std::string& message);
+
+    //    -         
+    static std::string numbered(uint64_t seq, const std::string& message);
+
+    //       seq,   limit,   REPLAY_BLOCK.
+    //      (seq -   ).
+    uint64_t replay_since(uint64_t seq, size_t limit, std::vector<net_utils::SharedFrame>& blocks) const;
+
+    uint64_t first_seq() const;     //    
+    uint64_t last_seq() const;      // 0 -  
+};
@@ -0,0 +1,238 @@
+#include "Logger.h"
+#include "../Common/net_utils.h"
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <algorithm>
+
+namespace {
+    //     thread_local:     ,
+    //     
+    struct RingHolder {
+        std::shared_ptr<Logger::Ring> ring;
+
+        ~RingHolder() {
+            if (ring) ring->retired.store(true, std::memory_order_release);
+        }
+    };
+
+    thread_local RingHolder ring_holder;
+
+    void append(std::vector<char>& out, const char* data, size_t size) {
+        out.insert(out.end(), data, data + size);
+    }
+}
+
+Logger::Logger() {
+    writer_ = std::thread(&Logger::writer_loop, this);
+}
+
+Logger::~Logger() {
+    running_.store(false, std::memory_order_release);
+    if (writer_.joinable()) writer_.join();
+}
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Ring& Logger::ring() {
+    Ring* ring = ring_holder.ring.get();
+    if (ring) return *ring;
+
+    //    -    
+    auto created = std::make_shared<Ring>();
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        created->thread = next_thread_++;
+        rings_.push_back(created);
+    }
+    ring_holder.ring = created;
+    return *created;
+}
+
+void Logger::write(LogLevel level, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    write_args(level, format, args);
+    va_end(args);
+}
+
+void Logger::write_args(LogLevel level, const char* format, va_list args) {
+    Ring& ring = this->ring();
+
+    //     :     
+    if (level < LogLevel::Warn) {
+        uint32_t every = sample_every_.load(std::memory_order_relaxed);
+        if (every > 1 && ring.sample_counter++ % every != 0) {
+            ring.sampled_out.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) >= RING_SIZE) {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Record& record = ring.records[head & (RING_SIZE - 1)];
+    record.time_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    record.thread = ring.thread;
+    record.level = level;
+    int length = vsnprintf(record.text, TEXT_SIZE, format, args);
+    record.length = (uint16_t)(length < 0 ? 0 : std::min<size_t>(length, TEXT_SIZE - 1));
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+//    .      
+//    ,     .
+size_t Logger::drain(Ring& ring, std::vector<char>& out, int64_t& cached_second, char* cached_prefix) {
+    uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    uint64_t head = ring.head.load(std::memory_order_acquire);
+    size_t count = 0;
+
+    for (; tail != head; ++tail, ++count) {
+        const Record& record = ring.records[tail & (RING_SIZE - 1)];
+        int64_t second = record.time_us / 1000000;
+        if (second != cached_second) {
+            time_t time = (time_t)second;
+            struct tm time_info;
+            localtime_s(&time_info, &time);
+            strftime(cached_prefix, 32, "%Y-%m-%d %H:%M:%S", &time_info);
+            cached_second = second;
+        }
+
+        char fields[64];
+        int length = snprintf(fields, sizeof(fields), "%s.%03d %-5s [%u] ", cached_prefix,
+            (int)(record.time_us / 1000 % 1000), level_name(record.level), record.thread);
+        append(out, fields, std::min<size_t>(std::max(length, 0), sizeof(fields) - 1));
+        append(out, record.text, record.length);
+        out.push_back('\n');
+    }
+
+    ring.tail.store(tail, std::memory_order_release);
+    return count;
+}
+
+void Logger::writer_loop() {
+    std::vector<char> out;
+    out.reserve(64 * 1024);
+    std::vector<std::shared_ptr<Ring>> rings;
+    int64_t cached_second = -1;
+    char cached_prefix[32] = "";
+    uint64_t reported_dropped = 0;
+
+    while (true) {
+        //    :    
+        bool stopping = !running_.load(std::memory_order_acquire);
+        {
+            std::lock_guard<std::mutex> lock(rings_mutex_);
+            rings = rings_;
+        }
+
+        size_t drained = 0;
+        for (const auto& ring : rings) {
+            drained += drain(*ring, out, cached_second, cached_prefix);
+        }
+
+        uint64_t lost = dropped();
+        if (lost != reported_dropped) {
+            char warning[96];
+            int length = snprintf(warning, sizeof(warning), "Logger: %llu messages dropped (rings full)\n",
+                (unsigned long long)(lost - reported_dropped));
+            append(out, warning, std::min<size_t>(std::max(length, 0), sizeof(warning) - 1));
+            reported_dropped = lost;
+        }
+
+        if (!out.empty()) {
+            FILE* output = output_.load(std::memory_order_acquire);
+            fwrite(out.data(), 1, out.size(), output);
+            fflush(output);
+            out.clear();
+        }
+        written_.fetch_add(drained, std::memory_order_relaxed);
+
+        //   ,  , - 
+        {
+            std::lock_guard<std::mutex> lock(rings_mutex_);
+            rings_.erase(std::remove_if(rings_.begin(), rings_.end(), [&](const std::shared_ptr<Ring>& ring) {
+                bool done = ring->retired.load(std::memory_order_acquire) &&
+                    ring->tail.load(std::memory_order_relaxed) == ring->head.load(std::memory_order_acquire);
+                if (done) {
+                    retired_dropped_ += ring->dropped.load(std::memory_order_relaxed);
+                    retired_sampled_out_ += ring->sampled_out.load(std::memory_order_relaxed);
+                }
+                return done;
+            }), rings_.end());
+        }
+        rings.clear();
+        rounds_.fetch_add(1, std::memory_order_release);
+
+        if (stopping) break;
+        if (drained == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void Logger::flush() {
+    std::vector<std::pair<std::shared_ptr<Ring>, uint64_t>> targets;
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        for (const auto& ring : rings_) {
+            targets.emplace_back(ring, ring->head.load(std::memory_order_acquire));
+        }
+    }
+
+    for (const auto& target : targets) {
+        while (target.first->tail.load(std::memory_order_acquire) < target.second &&
+            writer_.joinable()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    //  -   ,      stdout
+    uint64_t round = rounds_.load(std::memory_order_acquire);
+    while (rounds_.load(std::memory_order_acquire) < round + 2 && running_.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+uint64_t Logger::dropped() {
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    uint64_t total = retired_dropped_;
+    for (const auto& ring : rings_) total += ring->dropped.load(std::memory_order_relaxed);
+    return total;
+}
+
+uint64_t Logger::sampled_out() {
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    uint64_t total = retired_sampled_out_;
+    for (const auto& ring : rings_) total += ring->sampled_out.load(std::memory_order_relaxed);
+    return total;
+}
+
+bool Logger::parse_level(const char* name, LogLevel& level) {
+    static const struct { const char* name; LogLevel level; } levels[] = {
+        { "debug", LogLevel::Debug }, { "info", LogLevel::Info }, { "warn", LogLevel::Warn },
+        { "error", LogLevel::Error }, { "off", LogLevel::Off }
+    };
+    for (const auto& entry : levels) {
+        if (strcmp(entry.name, name) == 0) {
+            level = entry.level;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* Logger::level_name(LogLevel level) {
+    switch (level) {
+    case LogLevel::Debug: return "DEBUG";
+    case LogLevel::Info: return "INFO";
+    case LogLevel::Warn: return "WARN";
+    case LogLevel::Error: return "ERROR";
+    default: return "OFF";
+    }
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdarg>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+enum class LogLevel : uint8_t {
+    Debug,
+    Info,
+    Warn,
+    Error,
+    Off
+};
+
+//  .       ( ,
+//   -  ),    .  :
+//  , , snprintf  .   -  
+//  ,    .
+class Logger {
+public:
+    static const size_t TEXT_SIZE = 232;        //   - 248 
+    static const size_t RING_SIZE = 256;        //    ( )
+
+    struct Record {
+        int64_t time_us;        //   (system_clock)
+        uint32_t thread;        //    
+        LogLevel level;
+        uint16_t length;
+        char text[TEXT_SIZE];
+    };
+
+    //   : head  , tail -  
+    struct Ring {
+        std::unique_ptr<Record[]> records{ new Record[RING_SIZE] };
+        uint32_t thread = 0;
+        uint64_t sample_counter = 0;                //  -
+        alignas(64) std::atomic<uint64_t> head{ 0 };
+        alignas(64) std::atomic<uint64_t> tail{ 0 };
+        std::atomic<uint64_t> dropped{ 0 };
+        std::atomic<uint64_t> sampled_out{ 0 };
+        std::atomic<bool> retired{ false };         //  ,    
+    };
+private:
+    std::atomic<LogLevel> level_{ LogLevel::Info };
+    std::atomic<uint32_t> sample_every_{ 1 };      // Debug/Info:   N-
+
+    std::mutex rings_mutex_;
+    std::vector<std::shared_ptr<Ring>> rings_;
+    uint32_t next_thread_ = 0;
+
+    uint64_t retired_dropped_ = 0;                 //    
+    uint64_t retired_sampled_out_ = 0;
+
+    std::atomic<FILE*> output_{ stdout };
+
+    std::atomic<bool> running_{ true };
+    std::atomic<uint64_t> written_{ 0 };
+    std::atomic<uint64_t> rounds_{ 0 };            //   ( flush)
+    std::thread writer_;
+
+    Logger();
+    Ring& ring();
+    void writer_loop();
+    size_t drain(Ring& ring, std::vector<char>& out, int64_t& cached_second, char* cached_prefix);
+public:
+    ~Logger();
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    static Logger& instance();
+
+    bool enabled(LogLevel level) const {
+        return level >= level_.load(std::memory_order_relaxed);
+    }
+
+    void set_level(LogLevel level) {
+        level_.store(level, std::memory_order_relaxed);
+    }
+
+    LogLevel level() const {
+        return level_.load(std::memory_order_relaxed);
+    }
+
+    void set_sample_every(uint32_t every) {
+        sample_every_.store(every ? every : 1, std::memory_order_relaxed);
+    }
+
+    //     (  stdout);   
+    void set_output(FILE* file) {
+        output_.store(file ? file : stdout, std::memory_order_release);
+    }
+
+    // printf-:      
+    void write(LogLevel level, const char* format, ...);
+    void write_args(LogLevel level, const char* format, va_list args);
+
+    // ,       
+    void flush();
+
+    uint64_t written() const {
+        return written_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t dropped();
+
+    uint64_t sampled_out();
+
+    static bool parse_level(const char* name, LogLevel& level);
+    static const char* level_name(LogLevel level);
+};
+
+//   ,   
+#define LOG_AT(level, ...) \
+    do { \
+        if (Logger::instance().enabled(level)) Logger::instance().write(level, __VA_ARGS__); \
+    } while (0)
+
+#define LOG_DEBUG(...) LOG_AT(LogLevel::Debug, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(LogLevel::Info, __VA_ARGS__)
+#define LOG_WARN(...) LOG_AT(LogLevel::Warn, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(LogLevel::Error, __VA_ARGS__)
@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+#include <utility>
+
+// Lock-free  "  -  "    .
+//    CAS-   ,  
+//    exchange      FIFO.
+template <typename T>
+class Mailbox {
+private:
+    struct Node {
+        T value;
+        Node* next;
+    };
+
+    std::atomic<Node*> head_{ nullptr };
+public:
+    Mailbox() = default;
+    Mailbox(const Mailbox&) = delete;
+    Mailbox& operator=(const Mailbox&) = delete;
+
+    ~Mailbox() {
+        drain([](T&) {});
+    }
+
+    //  true,     -   
+    bool push(T value) {
+        Node* node = new Node{ std::move(value), nullptr };
+        Node* old_head = head_.load(std::memory_order_relaxed);
+        do {
+            node->next = old_head;
+        } while (!head_.compare_exchange_weak(old_head, node,
+            std::memory_order_release, std::memory_order_relaxed));
+        return old_head == nullptr;
+    }
+
+    //    ( -)
+    template <typename Handler>
+    size_t drain(Handler&& handler) {
+        Node* list = head_.exchange(nullptr, std::memory_order_acquire);
+
+        //  ,    
+        Node* ordered = nullptr;
+        while (list) {
+            Node* next = list->next;
+            list->next = ordered;
+            ordered = list;
+            list = next;
+        }
+
+        size_t count = 0;
+        while (ordered) {
+            Node* next = ordered->next;
+            handler(ordered->value);
+            delete ordered;
+            ordered = next;
+            ++count;
+        }
+        return count;
+    }
+};
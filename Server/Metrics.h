@@ -0,0 +1,355 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+//  : ,    .
+//  -        (   ),
+//     .  -    Prometheus.
+//    (_bucket{le=...}),    :
+//       ,    Prometheus
+//     - histogram_quantile(0.99, rate(x_bucket[5m])).
+
+//    :    
+inline size_t metric_shard() {
+    static std::atomic<size_t> next{ 0 };
+    thread_local size_t shard = next.fetch_add(1, std::memory_order_relaxed);
+    return shard;
+}
+
+//   
+class Counter {
+public:
+    static const size_t SHARDS = 16;
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{ 0 };
+    };
+
+    Shard shards_[SHARDS];
+public:
+    void add(uint64_t count = 1) {
+        shards_[metric_shard() % SHARDS].value.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    uint64_t value() const {
+        uint64_t total = 0;
+        for (const Shard& shard : shards_) total += shard.value.load(std::memory_order_relaxed);
+        return total;
+    }
+};
+
+// ,     (   )
+class Gauge {
+public:
+    static const size_t SHARDS = 16;
+private:
+    struct alignas(64) Shard {
+        std::atomic<int64_t> value{ 0 };
+    };
+
+    Shard shards_[SHARDS];
+public:
+    void add(int64_t delta) {
+        shards_[metric_shard() % SHARDS].value.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    int64_t value() const {
+        int64_t total = 0;
+        for (const Shard& shard : shards_) total += shard.value.load(std::memory_order_relaxed);
+        return total;
+    }
+};
+
+//    HDR:    ,  
+//  16   -     1/16   .
+//  -  (, );  2^41,  -   .
+class Histogram {
+public:
+    static const size_t SHARDS = 8;
+    static const int SUB_BITS = 4;
+    static const uint64_t SUB_COUNT = 1 << SUB_BITS;
+    static const int MAX_BIT = 40;
+    static const size_t BUCKETS = (MAX_BIT - SUB_BITS + 2) * SUB_COUNT;
+
+    struct Snapshot {
+        std::vector<uint64_t> buckets;
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+
+        //   ,     q (  )
+        uint64_t percentile(double q) const {
+            if (count == 0) return 0;
+            uint64_t rank = (uint64_t)(q * count);
+            if (rank < 1) rank = 1;
+            uint64_t seen = 0;
+            for (size_t i = 0; i < buckets.size(); ++i) {
+                seen += buckets[i];
+                if (seen >= rank) return std::min(upper_bound(i), max);
+            }
+            return max;
+        }
+    };
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> count{ 0 };
+        std::atomic<uint64_t> sum{ 0 };
+        std::atomic<uint64_t> max{ 0 };
+        std::atomic<uint64_t> buckets[BUCKETS] = {};
+    };
+
+    std::unique_ptr<Shard[]> shards_{ new Shard[SHARDS] };
+
+    static int highest_bit(uint64_t value) {
+        #ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return (int)index;
+        #else
+        return 63 - __builtin_clzll(value);
+        #endif
+    }
+public:
+    static size_t bucket_of(uint64_t value) {
+        if (value < SUB_COUNT) return (size_t)value;
+        int bit = highest_bit(value);
+        if (bit > MAX_BIT) return BUCKETS - 1;
+        return (size_t)(bit - SUB_BITS + 1) * SUB_COUNT +
+            (size_t)((value >> (bit - SUB_BITS)) & (SUB_COUNT - 1));
+    }
+
+    static uint64_t lower_bound(size_t bucket) {
+        if (bucket < SUB_COUNT) return bucket;
+        int bit = (int)(bucket / SUB_COUNT) + SUB_BITS - 1;
+        return (SUB_COUNT + bucket % SUB_COUNT) << (bit - SUB_BITS);
+    }
+
+    static uint64_t upper_bound(size_t bucket) {
+        return bucket + 1 < BUCKETS ? lower_bound(bucket + 1) - 1 : UINT64_MAX;
+    }
+
+    //    
+    static uint64_t now_ns() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void record(uint64_t value) {
+        Shard& shard = shards_[metric_shard() % SHARDS];
+        shard.buckets[bucket_of(value)].fetch_add(1, std::memory_order_relaxed);
+        shard.count.fetch_add(1, std::memory_order_relaxed);
+        shard.sum.fetch_add(value, std::memory_order_relaxed);
+        uint64_t max = shard.max.load(std::memory_order_relaxed);
+        while (value > max && !shard.max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    Snapshot snapshot() const {
+        Snapshot result;
+        result.buckets.assign(BUCKETS, 0);
+        for (size_t s = 0; s < SHARDS; ++s) {
+            const Shard& shard = shards_[s];
+            for (size_t i = 0; i < BUCKETS; ++i) {
+                result.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+            }
+            result.count += shard.count.load(std::memory_order_relaxed);
+            result.sum += shard.sum.load(std::memory_order_relaxed);
+            result.max = std::max(result.max, shard.max.load(std::memory_order_relaxed));
+        }
+        return result;
+    }
+};
+
+//   .  -     
+// (   ),    .
+class MetricsRegistry {
+public:
+    enum class Type {
+        Counter,
+        Gauge,
+        Histogram       //  ,    
+    };
+private:
+    struct Series {
+        std::string labels;                 //  : command="HELLO"
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+        double scale = 1;                   //   ->  
+        std::function<double()> read;       //    
+        const void* owner = nullptr;        //  read (. remove_owner)
+    };
+
+    struct Family {
+        std::string name;
+        std::string help;
+        Type type;
+        std::vector<std::unique_ptr<Series>> series;
+    };
+
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<Family>> families_;
+
+    MetricsRegistry() = default;
+
+    //  mutex_
+    Series& series(const std::string& name, const std::string& help, Type type,
+        const std::string& labels) {
+        Family* family = nullptr;
+        for (auto& existing : families_) {
+            if (existing->name == name) family = existing.get();
+        }
+        if (!family) {
+            families_.emplace_back(new Family{ name, help, type, {} });
+            family = families_.back().get();
+        }
+        else if (family->type != type) {
+            throw std::runtime_error("metric " + name + " registered with another type");
+        }
+
+        for (auto& existing : family->series) {
+            if (existing->labels == labels) return *existing;
+        }
+        family->series.emplace_back(new Series());
+        family->series.back()->labels = labels;
+        return *family->series.back();
+    }
+
+    static void append_value(std::string& out, const std::string& name, const std::string& labels,
+        const char* extra_label, double value) {
+        out += name;
+        if (!labels.empty() || extra_label) {
+            out += '{';
+            out += labels;
+            if (extra_label) {
+                if (!labels.empty()) out += ',';
+                out += extra_label;
+            }
+            out += '}';
+        }
+        char text[64];
+        if (value != value) snprintf(text, sizeof(text), " NaN\n");
+        else snprintf(text, sizeof(text), " %.9g\n", value);
+        out += text;
+    }
+
+    //   Prometheus:  -   ( SUB_COUNT 
+    // ),  .    - rate()   .
+    static void append_buckets(std::string& out, const std::string& name, const std::string& labels,
+        const Histogram::Snapshot& snapshot, double scale) {
+        uint64_t cumulative = 0;
+        size_t bucket = 0;
+        for (int bit = 0; bit <= Histogram::MAX_BIT + 1; ++bit) {
+            //    2^bit
+            uint64_t limit = 1ull << bit;
+            while (bucket + 1 < Histogram::BUCKETS && Histogram::upper_bound(bucket) < limit) {
+                cumulative += snapshot.buckets[bucket++];
+            }
+            char le[48];
+            snprintf(le, sizeof(le), "le=\"%.9g\"", (double)limit * scale);
+            append_value(out, name + "_bucket", labels, le, (double)cumulative);
+        }
+        append_value(out, name + "_bucket", labels, "le=\"+Inf\"", (double)snapshot.count);
+    }
+public:
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    static MetricsRegistry& instance() {
+        static MetricsRegistry registry;
+        return registry;
+    }
+
+    //           
+    Counter& counter(const std::string& name, const std::string& help, const std::string& labels = "") {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Series& found = series(name, help, Type::Counter, labels);
+        if (!found.counter) found.counter.reset(new Counter());
+        return *found.counter;
+    }
+
+    Gauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "") {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Series& found = series(name, help, Type::Gauge, labels);
+        if (!found.gauge) found.gauge.reset(new Gauge());
+        return *found.gauge;
+    }
+
+    // scale       ( ->   )
+    Histogram& histogram(const std::string& name, const std::string& help,
+        const std::string& labels = "", double scale = 1e-9) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Series& found = series(name, help, Type::Histogram, labels);
+        if (!found.histogram) found.histogram.reset(new Histogram());
+        found.scale = scale;
+        return *found.histogram;
+    }
+
+    // ,     ,    
+    void observe(const std::string& name, const std::string& help, Type type,
+        const std::string& labels, const void* owner, std::function<double()> read) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Series& found = series(name, help, type, labels);
+        found.read = std::move(read);
+        found.owner = owner;
+    }
+
+    //  :  read   
+    void remove_owner(const void* owner) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& family : families_) {
+            for (auto& entry : family->series) {
+                if (entry->owner == owner) {
+                    entry->read = nullptr;
+                    entry->owner = nullptr;
+                }
+            }
+        }
+    }
+
+    //   Prometheus 0.0.4
+    std::string render() {
+        std::string out;
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& family : families_) {
+            static const char* TYPE_NAMES[] = { "counter", "gauge", "histogram" };
+            out += "# HELP " + family->name + " " + family->help + "\n";
+            out += "# TYPE " + family->name + " " + TYPE_NAMES[(int)family->type] + "\n";
+
+            for (const auto& entry : family->series) {
+                if (entry->histogram) {
+                    Histogram::Snapshot snapshot = entry->histogram->snapshot();
+                    append_buckets(out, family->name, entry->labels, snapshot, entry->scale);
+                    append_value(out, family->name + "_sum", entry->labels, nullptr,
+                        snapshot.sum * entry->scale);
+                    append_value(out, family->name + "_count", entry->labels, nullptr,
+                        (double)snapshot.count);
+                }
+                else if (entry->counter) {
+                    append_value(out, family->name, entry->labels, nullptr, (double)entry->counter->value());
+                }
+                else if (entry->gauge) {
+                    append_value(out, family->name, entry->labels, nullptr, (double)entry->gauge->value());
+                }
+                else if (entry->read) {
+                    append_value(out, family->name, entry->labels, nullptr, entry->read());
+                }
+            }
+        }
+        return out;
+    }
+};
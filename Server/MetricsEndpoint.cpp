@@ -0,0 +1,83 @@
+#include "MetricsEndpoint.h"
+#include "Metrics.h"
+#include <stdexcept>
+#include <string>
+
+MetricsEndpoint::MetricsEndpoint(int port) : port_(port) {
+    if (!net_utils::net_init()) {
+        throw std::runtime_error("Network init failed");
+    }
+
+    listen_socket_ = net_utils::create_tcp_socket();
+    if (listen_socket_ == net_utils::INVALID_SOCKET_VAL) {
+        net_utils::net_cleanup();
+        throw std::runtime_error("Metrics socket creation failed");
+    }
+
+    int reuse = 1;
+    setsockopt(listen_socket_, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+
+    //  :        
+    sockaddr_in addr;
+    net_utils::make_address("127.0.0.1", port, addr);
+    if (bind(listen_socket_, (sockaddr*)&addr, sizeof(addr)) == SOCKET_ERROR_VAL ||
+        listen(listen_socket_, 16) == SOCKET_ERROR_VAL) {
+        net_utils::socket_close(listen_socket_);
+        net_utils::net_cleanup();
+        throw std::runtime_error("Metrics port " + std::to_string(port) + " is not available");
+    }
+
+    thread_ = std::thread(&MetricsEndpoint::serve_loop, this);
+}
+
+MetricsEndpoint::~MetricsEndpoint() {
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    net_utils::socket_close(listen_socket_);
+    net_utils::net_cleanup();
+}
+
+void MetricsEndpoint::serve_loop() {
+    while (running_) {
+        //      200 ,   
+        if (!net_utils::wait_readable(listen_socket_, 200)) continue;
+
+        net_utils::socket_t client = accept(listen_socket_, nullptr, nullptr);
+        if (client == net_utils::INVALID_SOCKET_VAL) continue;
+
+        serve_client(client);
+        net_utils::socket_close(client);
+    }
+}
+
+// HTTP/1.0  keep-alive:  ,   
+void MetricsEndpoint::serve_client(net_utils::socket_t client) {
+    net_utils::set_timeout(client, 1000);
+
+    std::string request;
+    char buffer[1024];
+    while (request.size() < MAX_REQUEST && request.find("\r\n\r\n") == std::string::npos &&
+        request.find("\n\n") == std::string::npos) {
+        int received = recv(client, buffer, sizeof(buffer), 0);
+        if (received <= 0) break;
+        request.append(buffer, received);
+    }
+
+    std::string status = "200 OK";
+    std::string body;
+    if (request.rfind("GET /metrics", 0) == 0 || request.rfind("GET / ", 0) == 0) {
+        body = MetricsRegistry::instance().render();
+    }
+    else {
+        status = "404 Not Found";
+        body = "Use GET /metrics\n";
+    }
+
+    std::string response = "HTTP/1.0 " + status + "\r\n"
+        "Content-Type: text/plain; version=0.0.4\r\n"
+        "Content-Length: " + std::to_string(body.size()) + "\r\n"
+        "Connection: close\r\n\r\n" + body;
+    net_utils::send_all(client, response.data(), response.size());
+}
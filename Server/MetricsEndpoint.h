@@ -0,0 +1,27 @@
+#pragma once
+#include "../Common/net_utils.h"
+#include <atomic>
+#include <thread>
+
+//  : GET /metrics   MetricsRegistry
+//    Prometheus.   127.0.0.1.
+//   -      .
+class MetricsEndpoint {
+private:
+    net_utils::socket_t listen_socket_;
+    int port_;
+    std::atomic<bool> running_{ true };
+    std::thread thread_;
+
+    static const size_t MAX_REQUEST = 4096;
+public:
+    explicit MetricsEndpoint(int port);
+    ~MetricsEndpoint();
+    MetricsEndpoint(const MetricsEndpoint&) = delete;
+    MetricsEndpoint& operator=(const MetricsEndpoint&) = delete;
+
+    int port() const { return port_; }
+private:
+    void serve_loop();
+    void serve_client(net_utils::socket_t client);
+};
@@ -0,0 +1,318 @@
+#pragma once
+#include "../Common/net_utils.h"
+#include "Metrics.h"
+#include <deque>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+//  ,     
+enum class OverflowPolicy {
+    DropOldest,     //    
+    DropNewest,     //      
+    Disconnect      //  
+};
+
+struct QueueLimits {
+    size_t high_watermark = 1024 * 1024;    //  -  
+    size_t low_watermark = 256 * 1024;      //  -   
+    OverflowPolicy policy = OverflowPolicy::DropOldest;
+    size_t zerocopy_threshold = 0;          //     - MSG_ZEROCOPY (0 - )
+};
+
+//     (  TCP-)
+struct OutboundMetrics {
+    Histogram& depth = MetricsRegistry::instance().histogram("chat_outbound_queue_bytes",
+        "Send queue depth of a connection after each enqueue", "", 1);
+    Counter& dropped = MetricsRegistry::instance().counter("chat_outbound_dropped_total",
+        "Frames dropped by the overflow policy");
+    Counter& sent_bytes = MetricsRegistry::instance().counter("chat_tx_bytes_total",
+        "Bytes written to client sockets");
+    Counter& zerocopy_sends = MetricsRegistry::instance().counter("chat_zerocopy_sends_total",
+        "Sends made with MSG_ZEROCOPY");
+    Counter& zerocopy_bytes = MetricsRegistry::instance().counter("chat_zerocopy_bytes_total",
+        "Bytes sent with MSG_ZEROCOPY");
+    Counter& zerocopy_copied = MetricsRegistry::instance().counter("chat_zerocopy_copied_total",
+        "Zero-copy sends the kernel completed by copying after all");
+    Gauge& zerocopy_pending = MetricsRegistry::instance().gauge("chat_zerocopy_pending_frames",
+        "Frames held until the kernel reports their zero-copy send complete");
+
+    static OutboundMetrics& get() {
+        static OutboundMetrics metrics;
+        return metrics;
+    }
+};
+
+//      .
+//   (SharedFrame):   ,   .
+//  MSG_ZEROCOPY         -  
+//  ,   .   ,     .
+//  :   .
+class OutboundQueue {
+public:
+    enum class PushResult {
+        Queued,
+        Dropped,        //  ( ) 
+        Overflow        //  Disconnect -   
+    };
+private:
+    std::deque<net_utils::SharedFrame> frames_;
+    size_t bytes_ = 0;          //    
+    size_t head_offset_ = 0;    //      
+    bool congested_ = false;    //  high,     low
+    size_t dropped_ = 0;        //   
+    QueueLimits limits_;
+
+    //   MSG_ZEROCOPY,    :    
+    struct ZerocopySend {
+        uint32_t id;
+        net_utils::SharedFrame frame;
+    };
+    bool zerocopy_ = false;
+    uint32_t zerocopy_next_ = 0;
+    std::deque<ZerocopySend> zerocopy_pending_;
+public:
+    explicit OutboundQueue(const QueueLimits& limits = QueueLimits()) : limits_(limits) {}
+
+    OutboundQueue(OutboundQueue&&) = default;
+    OutboundQueue& operator=(OutboundQueue&&) = default;
+
+    ~OutboundQueue() {
+        if (!zerocopy_pending_.empty()) {
+            OutboundMetrics::get().zerocopy_pending.add(-(int64_t)zerocopy_pending_.size());
+        }
+    }
+
+    void set_policy(OverflowPolicy policy) { limits_.policy = policy; }
+
+    bool empty() const { return frames_.empty(); }
+    bool zerocopy() const { return zerocopy_; }
+    size_t zerocopy_pending() const { return zerocopy_pending_.size(); }
+
+    //   -  MSG_ZEROCOPY,       
+    bool enable_zerocopy(net_utils::socket_t socket) {
+        zerocopy_ = limits_.zerocopy_threshold > 0 && net_utils::enable_zerocopy(socket);
+        return zerocopy_;
+    }
+
+    //      first..last:   .
+    //     -  (loopback,   scatter-gather) zero-copy
+    //  ,   .
+    void complete_zerocopy(uint32_t first, uint32_t last, bool copied) {
+        size_t released = 0;
+        while (!zerocopy_pending_.empty() &&
+            (uint32_t)(zerocopy_pending_.front().id - first) <= last - first) {
+            zerocopy_pending_.pop_front();
+            ++released;
+        }
+        OutboundMetrics::get().zerocopy_pending.add(-(int64_t)released);
+        if (copied) {
+            OutboundMetrics::get().zerocopy_copied.add(last - first + 1);
+            zerocopy_ = false;
+        }
+    }
+    size_t bytes() const { return bytes_; }
+    size_t dropped() const { return dropped_; }
+
+    PushResult push(const net_utils::SharedFrame& frame) {
+        PushResult result = PushResult::Queued;
+
+        if (!congested_ && bytes_ + frame->size() > limits_.high_watermark) {
+            congested_ = true;
+        }
+
+        if (congested_) {
+            switch (limits_.policy) {
+            case OverflowPolicy::Disconnect:
+                return PushResult::Overflow;
+            case OverflowPolicy::DropNewest:
+                ++dropped_;
+                OutboundMetrics::get().dropped.add();
+                return PushResult::Dropped;
+            case OverflowPolicy::DropOldest:
+                //    low,     
+                while (frames_.size() > (head_offset_ > 0 ? 1u : 0u) &&
+                    bytes_ + frame->size() > limits_.low_watermark) {
+                    auto victim = head_offset_ > 0 ? frames_.begin() + 1 : frames_.begin();
+                    bytes_ -= (*victim)->size();
+                    frames_.erase(victim);
+                    ++dropped_;
+                    OutboundMetrics::get().dropped.add();
+                }
+                congested_ = false;
+                result = PushResult::Dropped;
+                break;
+            }
+        }
+
+        bytes_ += frame->size();
+        frames_.push_back(frame);
+        OutboundMetrics::get().depth.record(bytes_);
+        return result;
+    }
+
+    //   max  ( -   ).
+    //  ,      .
+    size_t pop_batch(std::vector<net_utils::SharedFrame>& batch, size_t max) {
+        size_t offset = head_offset_;
+        while (!frames_.empty() && batch.size() < max) {
+            bytes_ -= frames_.front()->size() - head_offset_;
+            head_offset_ = 0;
+            batch.push_back(std::move(frames_.front()));
+            frames_.pop_front();
+        }
+        update_congestion();
+        return offset;
+    }
+
+    //     ,   
+    //   writev. false -  . calls ( ) -   .
+    //     zero-copy     MSG_ZEROCOPY.
+    bool flush(net_utils::socket_t socket, size_t* calls = nullptr) {
+        net_utils::IoSlice slices[net_utils::MAX_SLICES];
+
+        while (!frames_.empty()) {
+            bool zerocopy = is_large(frames_.front());
+            size_t count = 0;
+            for (auto it = frames_.begin(); it != frames_.end() && count < net_utils::MAX_SLICES; ++it) {
+                if (count > 0 && (zerocopy || is_large(*it))) break;
+                size_t skip = count == 0 ? head_offset_ : 0;
+                slices[count++] = { (*it)->data() + skip, (*it)->size() - skip };
+            }
+
+            long sent = net_utils::send_slices(socket, slices, count, false, &zerocopy);
+            if (calls) ++*calls;
+            if (sent < 0) return false;
+            if (sent == 0) break;
+
+            if (zerocopy) {
+                //         
+                zerocopy_pending_.push_back({ zerocopy_next_++, frames_.front() });
+                OutboundMetrics::get().zerocopy_sends.add();
+                OutboundMetrics::get().zerocopy_bytes.add((size_t)sent);
+                OutboundMetrics::get().zerocopy_pending.add(1);
+            }
+
+            //    
+            size_t done = (size_t)sent;
+            bytes_ -= done;
+            OutboundMetrics::get().sent_bytes.add(done);
+            while (done > 0) {
+                size_t left = frames_.front()->size() - head_offset_;
+                if (done < left) {
+                    head_offset_ += done;
+                    break;
+                }
+                done -= left;
+                frames_.pop_front();
+                head_offset_ = 0;
+            }
+        }
+        update_congestion();
+        return true;
+    }
+private:
+    bool is_large(const net_utils::SharedFrame& frame) const {
+        return zerocopy_ && frame->size() >= limits_.zerocopy_threshold;
+    }
+
+    void update_congestion() {
+        if (congested_ && bytes_ <= limits_.low_watermark) {
+            congested_ = false;
+        }
+    }
+};
+
+//    - ( "  ").
+//      ,     writer-.
+class QueuedWriter {
+private:
+    net_utils::socket_t socket_;
+    OutboundQueue queue_;
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    bool closing_ = false;
+    std::thread thread_;
+public:
+    QueuedWriter(net_utils::socket_t socket, const QueueLimits& limits)
+        : socket_(socket), queue_(limits) {
+        thread_ = std::thread(&QueuedWriter::write_loop, this);
+    }
+
+    ~QueuedWriter() {
+        close();
+    }
+
+    // false -      Disconnect
+    // (     ,   )
+    bool post(const net_utils::SharedFrame& frame) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closing_) return false;
+            if (queue_.push(frame) == OutboundQueue::PushResult::Overflow) {
+                closing_ = true;
+                net_utils::shutdown(socket_);
+                ready_.notify_one();
+                return false;
+            }
+        }
+        ready_.notify_one();
+        return true;
+    }
+
+    void set_policy(OverflowPolicy policy) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.set_policy(policy);
+    }
+
+    //  - (  )
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closing_ && !thread_.joinable()) return;
+            closing_ = true;
+        }
+        ready_.notify_one();
+        //  ,     send   
+        net_utils::shutdown(socket_);
+        if (thread_.joinable() && thread_.get_id() != std::this_thread::get_id()) {
+            thread_.join();
+        }
+    }
+private:
+    void write_loop() {
+        std::vector<net_utils::SharedFrame> batch;
+        std::vector<net_utils::IoSlice> slices;
+
+        while (true) {
+            size_t offset;
+            batch.clear();
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                ready_.wait(lock, [this] { return closing_ || !queue_.empty(); });
+                if (closing_) return;
+                offset = queue_.pop_batch(batch, net_utils::MAX_SLICES);
+            }
+
+            //   -  writev
+            slices.clear();
+            size_t batch_bytes = 0;
+            for (const auto& frame : batch) {
+                slices.push_back({ frame->data() + offset, frame->size() - offset });
+                batch_bytes += frame->size() - offset;
+                offset = 0;
+            }
+
+            if (!net_utils::send_slices_all(socket_, slices.data(), slices.size())) {
+                // :       
+                std::lock_guard<std::mutex> lock(mutex_);
+                closing_ = true;
+                net_utils::shutdown(socket_);
+                return;
+            }
+            OutboundMetrics::get().sent_bytes.add(batch_bytes);
+        }
+    }
+};
@@ -0,0 +1,122 @@
+#pragma once
+#include "../Common/net_utils.h"
+#include <cstdint>
+#include <cmath>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+#ifdef NET_LINUX
+#include <sys/timerfd.h>
+#include <time.h>
+#endif
+
+//     :    
+// (start + n * period),     .  Linux - timerfd
+//   ,  sleep_until.    .
+class RateTicker {
+public:
+    struct Stats {
+        uint64_t ticks = 0;         // 
+        uint64_t missed = 0;        // ,  
+        double mean_us = 0;         //  
+        double stddev_us = 0;
+        double max_us = 0;
+    };
+private:
+    std::chrono::nanoseconds period_;
+    std::chrono::steady_clock::time_point start_;
+    uint64_t tick_index_ = 0;       //    
+    uint64_t ticks_ = 0;
+    uint64_t missed_ = 0;
+    double sum_us_ = 0;
+    double sum_sq_us_ = 0;
+    double max_us_ = 0;
+    #ifdef NET_LINUX
+    int timer_fd_ = -1;
+    #endif
+
+    void record(uint64_t expirations) {
+        tick_index_ += expirations;
+        missed_ += expirations - 1;
+        ++ticks_;
+
+        auto scheduled = start_ + period_ * tick_index_;
+        double late_us = std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - scheduled).count();
+        late_us = std::max(0.0, late_us);
+        sum_us_ += late_us;
+        sum_sq_us_ += late_us * late_us;
+        max_us_ = std::max(max_us_, late_us);
+    }
+public:
+    // rate -    ( )
+    explicit RateTicker(double rate)
+        : period_(std::chrono::nanoseconds((int64_t)(1e9 / std::max(rate, 0.001)))),
+        start_(std::chrono::steady_clock::now()) {
+        #ifdef NET_LINUX
+        timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        if (timer_fd_ != -1) {
+            // steady_clock  libstdc++ -  CLOCK_MONOTONIC:    
+            int64_t start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                start_.time_since_epoch()).count() + period_.count();
+            itimerspec spec = {};
+            spec.it_value.tv_sec = start_ns / 1000000000;
+            spec.it_value.tv_nsec = start_ns % 1000000000;
+            spec.it_interval.tv_sec = period_.count() / 1000000000;
+            spec.it_interval.tv_nsec = period_.count() % 1000000000;
+            if (timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &spec, nullptr) != 0) {
+                close(timer_fd_);
+                timer_fd_ = -1;
+            }
+        }
+        #endif
+    }
+
+    ~RateTicker() {
+        #ifdef NET_LINUX
+        if (timer_fd_ != -1) close(timer_fd_);
+        #endif
+    }
+
+    RateTicker(const RateTicker&) = delete;
+    RateTicker& operator=(const RateTicker&) = delete;
+
+    //   .    ( 1 - ).
+    uint64_t wait() {
+        uint64_t expirations = 0;
+        #ifdef NET_LINUX
+        if (timer_fd_ != -1) {
+            while (read(timer_fd_, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+                if (errno != EINTR) return 0;
+            }
+            record(expirations);
+            return expirations;
+        }
+        #endif
+
+        //    ,   "period  "
+        auto next = start_ + period_ * (tick_index_ + 1);
+        std::this_thread::sleep_until(next);
+        auto elapsed = std::chrono::steady_clock::now() - start_;
+        expirations = std::max<uint64_t>(1, elapsed / period_ - tick_index_);
+        record(expirations);
+        return expirations;
+    }
+
+    std::chrono::nanoseconds period() const {
+        return period_;
+    }
+
+    Stats stats() const {
+        Stats result;
+        result.ticks = ticks_;
+        result.missed = missed_;
+        if (ticks_ > 0) {
+            result.mean_us = sum_us_ / ticks_;
+            result.stddev_us = std::sqrt(std::max(0.0, sum_sq_us_ / ticks_ - result.mean_us * result.mean_us));
+            result.max_us = max_us_;
+        }
+        return result;
+    }
+};
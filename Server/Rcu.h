@@ -0,0 +1,74 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+// ˸ RCU   "  -  ".
+//       (/);
+//    -,  -    .
+//    ,  synchronize()   
+//  :    ,    ,  .
+// synchronize()    ReadGuard -  .
+class RcuDomain {
+private:
+    static const unsigned SHARDS = 64;
+
+    struct alignas(64) ReaderShard {
+        std::atomic<long> readers[2];
+    };
+
+    ReaderShard shards_[SHARDS];
+    std::atomic<unsigned> phase_{ 0 };
+    std::mutex sync_mutex_;             //     
+
+    static unsigned shard_index() {
+        static std::atomic<unsigned> next_index{ 0 };
+        thread_local unsigned index = next_index++ % SHARDS;
+        return index;
+    }
+public:
+    RcuDomain() {
+        for (auto& shard : shards_) {
+            shard.readers[0] = 0;
+            shard.readers[1] = 0;
+        }
+    }
+
+    RcuDomain(const RcuDomain&) = delete;
+    RcuDomain& operator=(const RcuDomain&) = delete;
+
+    //   :  ,  
+    class ReadGuard {
+    private:
+        std::atomic<long>* counter_;
+    public:
+        explicit ReadGuard(RcuDomain& domain) {
+            unsigned phase = domain.phase_.load() & 1;
+            counter_ = &domain.shards_[shard_index()].readers[phase];
+            counter_->fetch_add(1);
+        }
+
+        ~ReadGuard() {
+            counter_->fetch_sub(1, std::memory_order_release);
+        }
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+    };
+
+    //    ,   
+    void synchronize() {
+        std::lock_guard<std::mutex> lock(sync_mutex_);
+
+        //  :     
+        //    ""  -     
+        for (int flip = 0; flip < 2; ++flip) {
+            unsigned old_phase = phase_.fetch_add(1) & 1;
+            for (auto& shard : shards_) {
+                while (shard.readers[old_phase].load() != 0) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+};
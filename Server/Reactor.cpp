@@ -0,0 +1,491 @@
+#include "Reactor.h"
+
+#ifdef NET_LINUX
+#include "Server.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include <iostream>
+#include <stdexcept>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/sendfile.h>
+
+// ,      
+static thread_local EpollReactor* current_reactor = nullptr;
+
+//   :         
+struct MailboxMetrics {
+    Histogram& delay = MetricsRegistry::instance().histogram("chat_mailbox_delay_seconds",
+        "From posting a task to another shard to running it there");
+    Histogram& depth = MetricsRegistry::instance().histogram("chat_mailbox_tasks",
+        "Tasks drained from a shard mailbox per wakeup", "", 1);
+
+    static MailboxMetrics& get() {
+        static MailboxMetrics metrics;
+        return metrics;
+    }
+};
+
+bool pin_current_thread(int cpu) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+}
+
+EpollReactor::EpollReactor(net_utils::socket_t listen_socket, int shard_index,
+    size_t max_frame_size, uint64_t idle_timeout_ms)
+    : listen_socket_(listen_socket), shard_index_(shard_index), max_frame_size_(max_frame_size),
+    idle_timeout_ms_(idle_timeout_ms),
+    syscalls_(MetricsRegistry::instance().counter("chat_io_syscalls_total",
+        "Socket and event-loop system calls made by reactors", "backend=\"epoll\"")) {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ == -1) {
+        throw std::runtime_error("epoll_create1 failed");
+    }
+
+    wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup_fd_ == -1) {
+        close(epoll_fd_);
+        throw std::runtime_error("eventfd failed");
+    }
+
+    net_utils::set_nonblocking(listen_socket_);
+
+    epoll_event ev = {};
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.fd = listen_socket_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_socket_, &ev);
+
+    ev.events = EPOLLIN;
+    ev.data.fd = wakeup_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &ev);
+}
+
+EpollReactor::~EpollReactor() {
+    while (!connections_.empty()) {
+        close_client(connections_.begin()->first);
+    }
+    close(wakeup_fd_);
+    close(epoll_fd_);
+}
+
+void EpollReactor::stop() {
+    running_ = false;
+    wakeup();
+}
+
+void EpollReactor::wakeup() {
+    uint64_t one = 1;
+    write(wakeup_fd_, &one, sizeof(one));
+    syscalls_.add();
+}
+
+bool EpollReactor::on_own_thread() const {
+    return current_reactor == this;
+}
+
+void EpollReactor::run() {
+    current_reactor = this;
+    std::cout << "Epoll reactor #" << shard_index_ << " started" << std::endl;
+
+    //          
+    int wait_ms = idle_timeout_ms_ ? (int)idle_timers_.tick_ms() : -1;
+
+    epoll_event events[MAX_EVENTS];
+    while (running_) {
+        int count = epoll_wait(epoll_fd_, events, MAX_EVENTS, wait_ms);
+        syscalls_.add();
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "epoll_wait failed: " << net_utils::get_last_error() << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            int fd = events[i].data.fd;
+
+            if (fd == listen_socket_) {
+                accept_clients();
+                continue;
+            }
+            if (fd == wakeup_fd_) {
+                process_mailbox();
+                continue;
+            }
+
+            auto it = connections_.find(fd);
+            if (it == connections_.end()) continue;
+
+            //  MSG_ZEROCOPY EPOLLERR -     ,   .
+            //   epoll    EPOLLHUP -    .
+            if ((events[i].events & EPOLLERR) && it->second.outbox.zerocopy_pending() > 0) {
+                OutboundQueue& outbox = it->second.outbox;
+                bool alive = net_utils::read_zerocopy_completions(fd,
+                    [&outbox](uint32_t first, uint32_t last, bool copied) {
+                        outbox.complete_zerocopy(first, last, copied);
+                    });
+                syscalls_.add(2);
+                if (!alive) {
+                    close_client(fd);
+                    continue;
+                }
+            }
+            //      
+            else if (events[i].events & EPOLLERR) {
+                close_client(fd);
+                continue;
+            }
+            if ((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLRDHUP)) && !read_client(it->second)) {
+                close_client(fd);
+                continue;
+            }
+            //      -    
+            size_t calls = 0;
+            if ((events[i].events & EPOLLOUT) &&
+                (!it->second.outbox.empty() || !it->second.downloads.empty()) &&
+                !write_client(it->second, calls)) {
+                drop_client(it->second);
+            }
+            syscalls_.add(calls);
+        }
+
+        flush_pending();
+        if (idle_timeout_ms_) {
+            expire_idle();
+        }
+    }
+
+    current_reactor = nullptr;
+    std::cout << "Epoll reactor #" << shard_index_ << " stopped" << std::endl;
+}
+
+//    ;     
+void EpollReactor::expire_idle() {
+    idle_timers_.advance(TimerWheel::now_ms(), [this](uint64_t socket) {
+        auto it = connections_.find((int)socket);
+        if (it == connections_.end()) return;
+
+        it->second.idle_timer = TimerWheel::NONE;
+        LOG_INFO("Idle timeout: client %d", it->second.client_id);
+        drop_client(it->second);
+    });
+}
+
+void EpollReactor::post_broadcast(const net_utils::SharedFrame& frame, int exclude_id) {
+    post_task({ Task::Broadcast, frame, -1, exclude_id, OverflowPolicy::DropOldest });
+}
+
+void EpollReactor::post_to_client(int client_id, const net_utils::SharedFrame& frame) {
+    post_task({ Task::Direct, frame, client_id, -1, OverflowPolicy::DropOldest });
+}
+
+void EpollReactor::post_overflow_policy(int client_id, OverflowPolicy policy) {
+    post_task({ Task::Policy, nullptr, client_id, -1, policy });
+}
+
+void EpollReactor::post_to_members(const net_utils::SharedFrame& frame,
+    const RoomRouter::MemberList& members, int exclude_id) {
+    post_task({ Task::Members, frame, -1, exclude_id, OverflowPolicy::DropOldest, members });
+}
+
+bool EpollReactor::post_file(int client_id, const net_utils::SharedFrame& announce,
+    const std::shared_ptr<StoredFile>& file, uint64_t offset) {
+    post_task({ Task::File, announce, client_id, -1, OverflowPolicy::DropOldest, nullptr, file, offset });
+    return true;
+}
+
+void EpollReactor::post_task(Task task) {
+    //     ,  
+    if (on_own_thread()) {
+        run_task(task);
+        return;
+    }
+    task.posted_ns = Histogram::now_ns();
+    if (mailbox_.push(std::move(task))) {
+        wakeup();
+    }
+}
+
+void EpollReactor::process_mailbox() {
+    //   eventfd,    -
+    //       
+    uint64_t value;
+    read(wakeup_fd_, &value, sizeof(value));
+    syscalls_.add();
+
+    MailboxMetrics& metrics = MailboxMetrics::get();
+    uint64_t now_ns = Histogram::now_ns();
+    size_t count = mailbox_.drain([&](Task& task) {
+        metrics.delay.record(now_ns > task.posted_ns ? now_ns - task.posted_ns : 0);
+        run_task(task);
+    });
+    metrics.depth.record(count);
+}
+
+void EpollReactor::run_task(Task& task) {
+    if (task.kind == Task::Broadcast) {
+        deliver_broadcast(task.frame, task.exclude_id);
+        return;
+    }
+    if (task.kind == Task::Members) {
+        //     - find_client    
+        for (int id : *task.members) {
+            if (id == task.exclude_id) continue;
+            Connection* conn = find_client(id);
+            if (conn) enqueue(*conn, task.frame);
+        }
+        return;
+    }
+
+    Connection* conn = find_client(task.client_id);
+    if (!conn) return;
+
+    if (task.kind == Task::Direct) {
+        enqueue(*conn, task.frame);
+    }
+    else if (task.kind == Task::File) {
+        //    outbox:    
+        //  ,     
+        conn->downloads.push_back({ task.file, task.offset, task.frame });
+        if (!conn->flush_pending) {
+            conn->flush_pending = true;
+            flush_list_.push_back(conn->socket);
+        }
+    }
+    else {
+        conn->outbox.set_policy(task.policy);
+    }
+}
+
+EpollReactor::Connection* EpollReactor::find_client(int client_id) {
+    auto id_it = sockets_by_id_.find(client_id);
+    if (id_it == sockets_by_id_.end()) return nullptr;
+
+    auto it = connections_.find(id_it->second);
+    return it != connections_.end() ? &it->second : nullptr;
+}
+
+void EpollReactor::deliver_broadcast(const net_utils::SharedFrame& frame, int exclude_id) {
+    for (auto& pair : connections_) {
+        if (pair.second.client_id == exclude_id) continue;
+        enqueue(pair.second, frame);
+    }
+}
+
+//    ;    -  flush_pending()
+void EpollReactor::enqueue(Connection& conn, const net_utils::SharedFrame& frame) {
+    if (conn.outbox.push(frame) == OutboundQueue::PushResult::Overflow) {
+        drop_client(conn);
+        return;
+    }
+    if (!conn.flush_pending) {
+        conn.flush_pending = true;
+        flush_list_.push_back(conn.socket);
+    }
+}
+
+//  ,     .    EPOLLOUT.
+void EpollReactor::flush_pending() {
+    size_t calls = 0;
+    for (size_t i = 0; i < flush_list_.size(); ++i) {
+        auto it = connections_.find(flush_list_[i]);
+        if (it == connections_.end()) continue;
+
+        Connection& conn = it->second;
+        conn.flush_pending = false;
+        if (!write_client(conn, calls)) {
+            drop_client(conn);
+        }
+    }
+    flush_list_.clear();
+    syscalls_.add(calls);
+}
+
+//   ,        :  
+//        . false -  .
+bool EpollReactor::write_client(Connection& conn, size_t& calls) {
+    while (true) {
+        if (conn.chunk_active) {
+            int result = send_chunk(conn, calls);
+            if (result <= 0) return result == 0;
+        }
+        if (!conn.outbox.empty()) {
+            if (!conn.outbox.flush(conn.socket, &calls)) return false;
+            if (!conn.outbox.empty()) return true;     //    -  EPOLLOUT
+        }
+        if (conn.downloads.empty()) return true;
+
+        Download& download = conn.downloads.front();
+        if (download.announce) {
+            //  FILE BEGIN -    
+            conn.header_left = download.announce->size();
+            conn.chunk_left = 0;
+            conn.chunk_active = true;
+            continue;
+        }
+
+        //  :    ,  -   
+        uint64_t left = download.file->size - std::min(download.offset, download.file->size);
+        size_t size = (size_t)std::min<uint64_t>(left, file_frame::CHUNK_SIZE);
+        uint8_t flags = size == left ? file_frame::FLAG_LAST : 0;
+        int length = (int)(file_frame::HEADER_SIZE + size);
+        memcpy(conn.chunk_header, &length, sizeof(length));
+        file_frame::encode_header(conn.chunk_header + sizeof(length), download.file->id,
+            download.offset, flags);
+        conn.header_left = CHUNK_HEADER_SIZE;
+        conn.chunk_left = size;
+        conn.chunk_active = true;
+    }
+}
+
+//   : 1 -  , 0 -   , -1 - 
+int EpollReactor::send_chunk(Connection& conn, size_t& calls) {
+    Download& download = conn.downloads.front();
+    const char* header = download.announce ? download.announce->data() : conn.chunk_header;
+    size_t header_size = download.announce ? download.announce->size() : CHUNK_HEADER_SIZE;
+    while (conn.header_left > 0) {
+        ssize_t sent = send(conn.socket, header + header_size - conn.header_left,
+            conn.header_left, MSG_NOSIGNAL | MSG_DONTWAIT | MSG_MORE);
+        ++calls;
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+        }
+        conn.header_left -= (size_t)sent;
+    }
+    while (conn.chunk_left > 0) {
+        off_t offset = (off_t)download.offset;
+        ssize_t sent = sendfile(conn.socket, download.file->fd, &offset,
+            (size_t)conn.chunk_left);
+        ++calls;
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+        }
+        if (sent == 0) return -1;      //     
+        download.offset += (uint64_t)sent;
+        conn.chunk_left -= (uint64_t)sent;
+        DownloadMetrics::get().bytes.add((uint64_t)sent);
+    }
+
+    conn.chunk_active = false;
+    if (download.announce) {
+        download.announce.reset();
+        return 1;
+    }
+    if (download.offset >= download.file->size) {
+        //    -     
+        file_store.downloaded(*download.file, conn.client_id);
+        conn.downloads.pop_front();
+        DownloadMetrics::get().files.add();
+    }
+    else if (conn.downloads.size() > 1) {
+        conn.downloads.push_back(std::move(download));
+        conn.downloads.pop_front();
+    }
+    return 1;
+}
+
+void EpollReactor::drop_client(Connection& conn) {
+    //    (   connections_):  shutdown
+    // epoll   ,    close_client
+    client_manager.disconnect_client(conn.client_id);
+    net_utils::shutdown(conn.socket);
+}
+
+void EpollReactor::accept_clients() {
+    // Edge-triggered: ,    
+    while (true) {
+        struct sockaddr_in client_addr;
+        socklen_t client_len = sizeof(client_addr);
+
+        int client_socket = accept4(listen_socket_, (struct sockaddr*)&client_addr,
+            &client_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        syscalls_.add();
+
+        if (client_socket == -1) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_ERROR("Error accept: %d", net_utils::get_last_error());
+            }
+            return;
+        }
+
+        int client_id = client_manager.add_client(client_socket, client_addr, shard_index_);
+        if (!client_id) {
+            LOG_WARN("Client table is full, connection rejected");
+            close(client_socket);
+            continue;
+        }
+        TimerWheel::Handle idle_timer = idle_timeout_ms_ ?
+            idle_timers_.arm(client_socket, idle_timeout_ms_, TimerWheel::now_ms()) : TimerWheel::NONE;
+        connections_.emplace(client_socket, Connection{ client_socket, client_id,
+            net_utils::FrameDecoder(max_frame_size_),
+            OutboundQueue(client_manager.queue_limits()), false, idle_timer });
+        sockets_by_id_[client_id] = client_socket;
+        if (client_manager.queue_limits().zerocopy_threshold > 0) {
+            connections_.at(client_socket).outbox.enable_zerocopy(client_socket);
+            syscalls_.add();
+        }
+
+        // EPOLLOUT  edge-      
+        epoll_event ev = {};
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.fd = client_socket;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, client_socket, &ev);
+        syscalls_.add();
+
+        on_client_connected(client_id, client_addr);
+
+        LOG_INFO("Total clients: %zu", client_manager.get_client_count());
+    }
+}
+
+//   EAGAIN (edge-triggered)     
+//   .  false,    .
+bool EpollReactor::read_client(Connection& conn) {
+    std::string message;
+
+    //  -  -    (   - )
+    if (conn.idle_timer != TimerWheel::NONE) {
+        idle_timers_.rearm(conn.idle_timer, idle_timeout_ms_, TimerWheel::now_ms());
+    }
+
+    while (true) {
+        net_utils::ReadStatus status = conn.decoder.fill(conn.socket);
+        syscalls_.add();
+
+        //  ,   ,    
+        while (conn.decoder.next_frame(message)) {
+            if (!message.empty() && !on_client_message(conn.client_id, message)) {
+                return false;
+            }
+        }
+
+        if (conn.decoder.failed()) {
+            LOG_WARN("Bad frame from client %d, disconnecting", conn.client_id);
+            return false;
+        }
+        if (status == net_utils::ReadStatus::WouldBlock) return true;
+        if (status != net_utils::ReadStatus::Ok) return false;
+    }
+}
+
+void EpollReactor::close_client(int socket) {
+    auto it = connections_.find(socket);
+    if (it == connections_.end()) return;
+
+    int client_id = it->second.client_id;
+    idle_timers_.cancel(it->second.idle_timer);
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, socket, nullptr);
+    connections_.erase(it);
+    sockets_by_id_.erase(client_id);
+
+    on_client_disconnected(client_id);
+    net_utils::socket_close(socket);
+    syscalls_.add(2);
+}
+#endif
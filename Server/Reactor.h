@@ -0,0 +1,113 @@
+#pragma once
+#include "../Common/net_utils.h"
+
+#ifdef NET_LINUX
+#include "ClientManager.h"
+#include "FileStore.h"
+#include "Mailbox.h"
+#include "Metrics.h"
+#include "OutboundQueue.h"
+#include "TimerWheel.h"
+#include <atomic>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//    epoll (edge-triggered),   .
+//   -  :    (SO_REUSEPORT)
+//   .         .
+class EpollReactor : public ClientShard {
+private:
+    // ,   :    
+    struct Download {
+        std::shared_ptr<StoredFile> file;
+        uint64_t offset;
+        net_utils::SharedFrame announce;    // FILE BEGIN,   
+    };
+
+    static const size_t CHUNK_HEADER_SIZE = sizeof(int) + file_frame::HEADER_SIZE;
+
+    struct Connection {
+        net_utils::socket_t socket;     //  
+        int client_id;                  // ID  ClientManager
+        net_utils::FrameDecoder decoder;    //     
+        OutboundQueue outbox;           //  ,  
+        bool flush_pending;             //      
+        TimerWheel::Handle idle_timer;  //   (NONE - )
+        //    ,  .   
+        // ,        outbox.
+        std::deque<Download> downloads{};
+        bool chunk_active = false;
+        char chunk_header[CHUNK_HEADER_SIZE] = {};
+        size_t header_left = 0;         //    ( )
+        uint64_t chunk_left = 0;        //   
+    };
+
+    //    
+    struct Task {
+        enum Kind { Broadcast, Direct, Policy, Members, File } kind;
+        net_utils::SharedFrame frame;   //  File -    
+        int client_id;                  //  (Direct, Policy, File)
+        int exclude_id;                 //   (Broadcast, Members)
+        OverflowPolicy policy;          //   (Policy)
+        RoomRouter::MemberList members{}; //      (Members)
+        std::shared_ptr<StoredFile> file{}; //       (File)
+        uint64_t offset = 0;
+        uint64_t posted_ns = 0;         //     ( )
+    };
+
+    net_utils::socket_t listen_socket_;
+    int shard_index_;
+    size_t max_frame_size_;
+    uint64_t idle_timeout_ms_;          // 0 -   
+    TimerWheel idle_timers_;            //  - 
+    Counter& syscalls_;                 //   (  io_uring)
+    int epoll_fd_;
+    int wakeup_fd_;                     // eventfd:    
+    std::atomic<bool> running_{ true };
+    std::unordered_map<int, Connection> connections_;    //  - 
+    std::unordered_map<int, int> sockets_by_id_;          // ID  -> 
+    std::vector<int> flush_list_;       //      
+    Mailbox<Task> mailbox_;
+
+    static const int MAX_EVENTS = 256;
+public:
+    EpollReactor(net_utils::socket_t listen_socket, int shard_index = 0,
+        size_t max_frame_size = net_utils::MAX_FRAME_SIZE, uint64_t idle_timeout_ms = 0);
+    ~EpollReactor();
+
+    void run();
+    void stop();
+
+    // ClientShard:     
+    void post_broadcast(const net_utils::SharedFrame& frame, int exclude_id) override;
+    void post_to_client(int client_id, const net_utils::SharedFrame& frame) override;
+    void post_overflow_policy(int client_id, OverflowPolicy policy) override;
+    void post_to_members(const net_utils::SharedFrame& frame,
+        const RoomRouter::MemberList& members, int exclude_id) override;
+    bool post_file(int client_id, const net_utils::SharedFrame& announce,
+        const std::shared_ptr<StoredFile>& file, uint64_t offset) override;
+private:
+    bool on_own_thread() const;
+    void wakeup();
+    void process_mailbox();
+    void post_task(Task task);
+    void run_task(Task& task);
+    Connection* find_client(int client_id);
+    void deliver_broadcast(const net_utils::SharedFrame& frame, int exclude_id);
+    void enqueue(Connection& conn, const net_utils::SharedFrame& frame);
+    void flush_pending();
+    bool write_client(Connection& conn, size_t& calls);
+    int send_chunk(Connection& conn, size_t& calls);
+    void drop_client(Connection& conn);
+    void expire_idle();
+
+    void accept_clients();
+    bool read_client(Connection& conn);
+    void close_client(int socket);
+};
+
+//      
+bool pin_current_thread(int cpu);
+#endif
@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+
+//       NACK.
+//     (seq % capacity),  .
+//    :     
+//    .
+class RetransmitRing {
+public:
+    enum Result {
+        COPIED,     //  ,  
+        MISSING,    //   ( )    
+        LIMITED     //   
+    };
+private:
+    struct Slot {
+        uint32_t seq = 0;
+        uint32_t size = 0;      // 0 -  
+    };
+
+    size_t capacity_;
+    size_t slot_size_;
+    std::vector<Slot> slots_;
+    std::vector<char> data_;
+    std::mutex mutex_;
+
+    //  : rate_   ,   burst_ 
+    double rate_;
+    double burst_;
+    double tokens_;
+    uint64_t refilled_ms_ = 0;
+
+    bool take_token(uint64_t now_ms) {
+        if (refilled_ms_ == 0) refilled_ms_ = now_ms;
+        tokens_ = std::min(burst_, tokens_ + (now_ms - refilled_ms_) * rate_ / 1000.0);
+        refilled_ms_ = now_ms;
+        if (tokens_ < 1.0) return false;
+        tokens_ -= 1.0;
+        return true;
+    }
+public:
+    RetransmitRing(size_t capacity, size_t slot_size, double max_per_second)
+        : capacity_(std::max<size_t>(1, capacity)), slot_size_(slot_size),
+        slots_(capacity_), data_(capacity_ * slot_size),
+        rate_(max_per_second), burst_(std::max(1.0, max_per_second / 10)), tokens_(burst_) {
+    }
+
+    RetransmitRing(const RetransmitRing&) = delete;
+    RetransmitRing& operator=(const RetransmitRing&) = delete;
+
+    //    (    -   )
+    void store(uint32_t seq, const char* data, size_t size) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot& slot = slots_[seq % capacity_];
+        slot.seq = seq;
+        slot.size = size <= slot_size_ ? (uint32_t)size : 0;
+        if (slot.size) memcpy(&data_[(seq % capacity_) * slot_size_], data, size);
+    }
+
+    //   seq  out (  slot_size() )
+    Result take(uint32_t seq, char* out, size_t& size, uint64_t now_ms) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const Slot& slot = slots_[seq % capacity_];
+        if (slot.size == 0 || slot.seq != seq) return MISSING;
+        if (!take_token(now_ms)) return LIMITED;
+        memcpy(out, &data_[(seq % capacity_) * slot_size_], slot.size);
+        size = slot.size;
+        return COPIED;
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    size_t slot_size() const {
+        return slot_size_;
+    }
+};
@@ -0,0 +1,141 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+
+//  :  -> ,    .
+// /    ID   O(1):    
+// ID -> ,   .   
+//   (MemberList)   ,     .
+//    -     ,  
+//        .  
+//       .
+class RoomRouter {
+public:
+    using MemberList = std::shared_ptr<const std::vector<int>>;
+private:
+    struct ShardMembers {
+        std::vector<int> ids;                       //   
+        std::unordered_map<int, size_t> positions;  // ID ->   ids
+        MemberList snapshot;                        // nullptr -   
+    };
+
+    struct Room {
+        std::vector<ShardMembers> by_shard;     //   
+        size_t size = 0;                        //  
+    };
+
+    struct TablePart {
+        std::mutex mutex;
+        std::unordered_map<std::string, Room> rooms;
+    };
+
+    static const size_t TABLE_PARTS = 64;
+
+    TablePart table_[TABLE_PARTS];
+    size_t shard_count_ = 1;
+    std::atomic<size_t> room_count_{ 0 };
+
+    TablePart& part_for(const std::string& room) {
+        return table_[std::hash<std::string>()(room) % TABLE_PARTS];
+    }
+public:
+    //     
+    void set_shard_count(size_t count) {
+        shard_count_ = std::max<size_t>(1, count);
+    }
+
+    size_t shard_count() const {
+        return shard_count_;
+    }
+
+    // false -    
+    bool join(const std::string& room, int client_id, int shard) {
+        TablePart& part = part_for(room);
+        std::lock_guard<std::mutex> lock(part.mutex);
+
+        auto it = part.rooms.find(room);
+        if (it == part.rooms.end()) {
+            it = part.rooms.emplace(room, Room()).first;
+            it->second.by_shard.resize(shard_count_);
+            ++room_count_;
+        }
+
+        Room& target = it->second;
+        ShardMembers& members = target.by_shard[shard];
+        if (!members.positions.emplace(client_id, members.ids.size()).second) {
+            return false;
+        }
+
+        members.ids.push_back(client_id);
+        members.snapshot.reset();
+        ++target.size;
+        return true;
+    }
+
+    // false -     
+    bool leave(const std::string& room, int client_id, int shard) {
+        TablePart& part = part_for(room);
+        std::lock_guard<std::mutex> lock(part.mutex);
+
+        auto it = part.rooms.find(room);
+        if (it == part.rooms.end()) return false;
+
+        Room& target = it->second;
+        ShardMembers& members = target.by_shard[shard];
+        auto pos = members.positions.find(client_id);
+        if (pos == members.positions.end()) return false;
+
+        //   :      
+        size_t index = pos->second;
+        int last = members.ids.back();
+        members.ids[index] = last;
+        members.positions[last] = index;
+        members.ids.pop_back();
+        members.positions.erase(client_id);
+        members.snapshot.reset();
+
+        if (--target.size == 0) {
+            part.rooms.erase(it);
+            --room_count_;
+        }
+        return true;
+    }
+
+    //     (,   ; nullptr -   ).
+    //          .
+    std::vector<MemberList> members(const std::string& room) {
+        TablePart& part = part_for(room);
+        std::lock_guard<std::mutex> lock(part.mutex);
+
+        auto it = part.rooms.find(room);
+        if (it == part.rooms.end()) return std::vector<MemberList>();
+
+        std::vector<MemberList> result;
+        result.reserve(it->second.by_shard.size());
+        for (ShardMembers& members : it->second.by_shard) {
+            if (!members.snapshot && !members.ids.empty()) {
+                members.snapshot = std::make_shared<const std::vector<int>>(members.ids);
+            }
+            result.push_back(members.snapshot);
+        }
+        return result;
+    }
+
+    size_t room_size(const std::string& room) {
+        TablePart& part = part_for(room);
+        std::lock_guard<std::mutex> lock(part.mutex);
+
+        auto it = part.rooms.find(room);
+        return it != part.rooms.end() ? it->second.size : 0;
+    }
+
+    size_t room_count() const {
+        return room_count_;
+    }
+};
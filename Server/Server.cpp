@@ -1,4 +1,13 @@
-#include "../Common/net_utils.h"
+#include "Server.h"
+#include "ClientManager.h"
+#include "FileStore.h"
+#include "HistoryLog.h"
+#include "Reactor.h"
+#include "UringReactor.h"
+#include "TimerWheel.h"
+#include "CommandTable.h"
+#include "Logger.h"
+#include "Metrics.h"
 #include <iostream>
 #include <thread>
 #include <vector>
@@ -6,200 +15,476 @@
 #include <mutex>
 #include <atomic>
 #include <algorithm>
+#include <memory>
+#include <chrono>
 
-class ClientManager {
-private:
-    struct Client {
-        net_utils::socket_t socket;            //  
-        struct sockaddr_in address; //  
-        std::string name;           //  
-        int id;                     //  ID
-        bool connected;             //  
-    };
-
-    //   ( )
-    std::map<int, Client> clients_;      //  
-    std::mutex clients_mutex_;           //    
-    std::atomic<int> next_client_id_{ 1 }; //  ID
-public:
-    int add_client(net_utils::socket_t socket, struct sockaddr_in address) {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-
-        int new_id = next_client_id_++;
-        Client new_client;
-        new_client.socket = socket;
-        new_client.address = address;
-        new_client.name = "User" + std::to_string(new_id);
-        new_client.id = new_id;
-        new_client.connected = true;
-
-        clients_[new_id] = new_client;
-        return new_id;
-    }
-
-    //  
-    void remove_client(int client_id) {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        auto it = clients_.find(client_id);
-        if (it != clients_.end()) {
-            clients_.erase(it);
-        }
+ClientManager client_manager;
+FileStore file_store;
+
+//     :   /sendfile  ,
+//        ,    
+static std::atomic<bool> file_transfers{ false };
+
+//    "  ":   ( - ID )
+//  ,         
+static std::mutex idle_mutex;
+static TimerWheel idle_timers;
+
+//   :   ,     /history, /since
+static HistoryLog history_log;
+static size_t history_replay_count = 0;
+static const size_t MAX_HISTORY_REPLAY = 1000;  //      
+
+static const size_t MAX_ROOM_NAME = 32;
+
+static bool valid_room_name(const std::string& room) {
+    return !room.empty() && room.size() <= MAX_ROOM_NAME &&
+        room.find(' ') == std::string::npos;
+}
+
+//   : /name 
+static void command_name(int client_id, std::string_view args) {
+    if (args.empty()) return;
+    std::string new_name(args);
+    std::string old_name = client_manager.get_client_name(client_id);
+    client_manager.set_client_name(client_id, new_name);
+
+    std::string msg = old_name + " changed name to " + new_name;
+    client_manager.broadcast_message(msg);
+}
+
+//   : /msg id 
+static void command_msg(int client_id, std::string_view args) {
+    size_t space_pos = args.find(' ');
+    if (space_pos == std::string_view::npos) return;
+
+    std::string target_id_str(args.substr(0, space_pos));
+    std::string_view private_msg = args.substr(space_pos + 1);
+
+    try {
+        int target_id = std::stoi(target_id_str);
+        std::string full_msg = "[Personally from " + client_manager.get_client_name(client_id) + "]: ";
+        full_msg.append(private_msg.data(), private_msg.size());
+        client_manager.send_to_client(target_id, full_msg);
+        client_manager.send_to_client(client_id,
+            "Message sent to user " + target_id_str);
+    }
+    catch (...) {
+        client_manager.send_to_client(client_id,
+            "Wrong user ID: " + target_id_str + " not found");
     }
+}
 
-    //   (   )
-    void disconnect_client(int client_id) {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        auto it = clients_.find(client_id);
-        if (it != clients_.end()) {
-            it->second.connected = false;
-        }
+//   
+static void command_users(int client_id, std::string_view) {
+    std::string user_list = "Connected users:\n";
+    auto connected_clients = client_manager.get_connected_clients();
+    for (int id : connected_clients) {
+            user_list += "ID: " + std::to_string(id) +
+                " - " + client_manager.get_client_name(id) + "\n";
     }
+    client_manager.send_to_client(client_id, user_list);
+}
 
-    //   
-    std::string get_client_name(int client_id) {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        auto it = clients_.find(client_id);
-        if (it != clients_.end()) {
-            return it->second.name;
-        }
-        return "Unknown";
+//    : /overflow oldest|newest|disconnect
+static void command_overflow(int client_id, std::string_view args) {
+    std::string mode(args);
+    if (mode == "oldest") {
+        client_manager.set_overflow_policy(client_id, OverflowPolicy::DropOldest);
     }
+    else if (mode == "newest") {
+        client_manager.set_overflow_policy(client_id, OverflowPolicy::DropNewest);
+    }
+    else if (mode == "disconnect") {
+        client_manager.set_overflow_policy(client_id, OverflowPolicy::Disconnect);
+    }
+    else {
+        client_manager.send_to_client(client_id, "Unknown overflow policy: " + mode);
+        return;
+    }
+    client_manager.send_to_client(client_id, "Overflow policy: " + mode);
+}
 
-    //   
-    void set_client_name(int client_id, const std::string& name) {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        auto it = clients_.find(client_id);
-        if (it != clients_.end()) {
-            it->second.name = name;
-        }
+//   : /join  ( )
+static void command_join(int client_id, std::string_view args) {
+    std::string room(args);
+    if (!valid_room_name(room)) {
+        client_manager.send_to_client(client_id, "Wrong room name: " + room);
+        return;
     }
+    client_manager.join_room(client_id, room);
+    client_manager.send_to_client(client_id, "You are in #" + room + " (" +
+        std::to_string(client_manager.get_room_size(room)) + " users)");
+    client_manager.room_message(room, "User " + client_manager.get_client_name(client_id) +
+        " joined #" + room, client_id);
+}
 
-    //   
-    net_utils::socket_t get_client_socket(int client_id) {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        auto it = clients_.find(client_id);
-        if (it != clients_.end()) {
-            return it->second.socket;
-        }
-        return net_utils::INVALID_SOCKET_VAL;
+//   : /leave [],   -  
+static void command_leave(int client_id, std::string_view args) {
+    std::string room = !args.empty() ? std::string(args)
+        : client_manager.get_client_room(client_id);
+    if (room.empty() || !client_manager.leave_room(client_id, room)) {
+        client_manager.send_to_client(client_id, "You are not in room " + room);
+        return;
     }
+    client_manager.send_to_client(client_id, "You left #" + room);
+    client_manager.room_message(room, "User " + client_manager.get_client_name(client_id) +
+        " left #" + room);
+}
+
+//      : /to  
+static void command_to(int client_id, std::string_view args) {
+    size_t space_pos = args.find(' ');
+    if (space_pos == std::string_view::npos) return;
 
-    //    
-    bool is_client_connected(int client_id) {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        auto it = clients_.find(client_id);
-        return it != clients_.end() && it->second.connected;
+    std::string room(args.substr(0, space_pos));
+    auto rooms = client_manager.get_client_rooms(client_id);
+    if (std::find(rooms.begin(), rooms.end(), room) == rooms.end()) {
+        client_manager.send_to_client(client_id, "You are not in room " + room);
+        return;
     }
+    std::string_view text = args.substr(space_pos + 1);
+    std::string message = "[#" + room + "] [" + client_manager.get_client_name(client_id) + "] ";
+    message.append(text.data(), text.size());
+    client_manager.room_message(room, message, client_id);
+}
 
-    //     
-    std::vector<int> get_connected_clients() {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        std::vector<int> result;
+//   
+static void command_rooms(int client_id, std::string_view) {
+    std::string current = client_manager.get_client_room(client_id);
+    std::string room_list = "Your rooms:\n";
+    for (const std::string& room : client_manager.get_client_rooms(client_id)) {
+        room_list += "#" + room + " - " +
+            std::to_string(client_manager.get_room_size(room)) + " users" +
+            (room == current ? " (current)" : "") + "\n";
+    }
+    room_list += "Rooms on server: " + std::to_string(client_manager.get_room_count());
+    client_manager.send_to_client(client_id, room_list);
+}
 
-        for (const auto& pair : clients_) {
-            if (pair.second.connected) {
-                result.push_back(pair.first);
-            }
-        }
+//     since:     ,
+//   -    ,     /since
+static void replay_history(int client_id, uint64_t since, size_t limit) {
+    std::vector<net_utils::SharedFrame> blocks;
+    uint64_t last = history_log.replay_since(since, limit, blocks);
+    for (const net_utils::SharedFrame& block : blocks) {
+        client_manager.send_frame(client_id, block);
+    }
 
-        return result;
+    if (last == since) {
+        client_manager.send_to_client(client_id, "History: nothing after #" + std::to_string(since));
+        return;
     }
+    std::string notice = "History: messages up to #" + std::to_string(last);
+    if (last < history_log.last_seq()) {
+        notice += ", more with /since " + std::to_string(last);
+    }
+    client_manager.send_to_client(client_id, notice);
+}
 
-    //   
-    size_t get_client_count() {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        return clients_.size();
+//    : /history [N]
+static void command_history(int client_id, std::string_view args) {
+    if (!history_log.enabled()) {
+        client_manager.send_to_client(client_id, "History is off on this server");
+        return;
+    }
+    size_t count = history_replay_count;
+    if (!args.empty()) {
+        try {
+            count = std::stoul(std::string(args));
+        }
+        catch (...) {
+            client_manager.send_to_client(client_id, "Usage: /history ['Count']");
+            return;
+        }
     }
-    void broadcast_message(const std::string& message, int exclude_id = -1) {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
+    count = std::min(count, MAX_HISTORY_REPLAY);
+    uint64_t last = history_log.last_seq();
+    replay_history(client_id, last > count ? last - count : 0, count);
+}
+
+//     : /since 'Seq' -   
+static void command_since(int client_id, std::string_view args) {
+    if (!history_log.enabled()) {
+        client_manager.send_to_client(client_id, "History is off on this server");
+        return;
+    }
+    uint64_t since = 0;
+    try {
+        since = std::stoull(std::string(args));
+    }
+    catch (...) {
+        client_manager.send_to_client(client_id, "Usage: /since 'Seq'");
+        return;
+    }
+    replay_history(client_id, since, MAX_HISTORY_REPLAY);
+}
 
-        for (auto& pair : clients_) {
-            Client& client = pair.second;
+//  :    
+struct UploadMetrics {
+    Counter& bytes = MetricsRegistry::instance().counter("chat_file_bytes_total",
+        "File bytes moved by /sendfile transfers", "direction=\"upload\"");
+    Counter& files = MetricsRegistry::instance().counter("chat_files_total",
+        "Files handled by /sendfile transfers", "event=\"stored\"");
 
-            //    
-            if (client.id == exclude_id) continue;
+    static UploadMetrics& get() {
+        static UploadMetrics metrics;
+        return metrics;
+    }
+};
 
-            //    
-            if (!client.connected) continue;
+//   :  - ,  - 
+static void offer_file(const StoredFile& file) {
+    std::string id = std::to_string(file.id);
+    std::string size = std::to_string(file.size);
+    client_manager.send_to_client(file.owner, "FILE STORED " + id + " " + size + " " + file.name);
+    //  :     
+    client_manager.send_to_client(file.recipient, "FILE OFFER " + id + " " + size + " " +
+        file.download_token + " " + std::to_string(file.owner.load()) + " " + file.name);
+    UploadMetrics::get().files.add();
+}
 
-            //  
-            if (!net_utils::send_message(client.socket, message)) {
-                //    -   
-                client.connected = false;
-            }
-        }
+//     : " ".      -  .
+// upload -   ,     .
+//      () .
+static std::shared_ptr<StoredFile> find_file(int client_id, std::string_view args, bool upload) {
+    size_t space_pos = args.find(' ');
+    std::string id(args.substr(0, space_pos));
+    std::string token(space_pos == std::string_view::npos ? std::string_view() : args.substr(space_pos + 1));
+    std::shared_ptr<StoredFile> file;
+    try {
+        file = file_store.find((uint32_t)std::stoul(id));
+    }
+    catch (...) {
     }
+    if (!file) {
+        client_manager.send_to_client(client_id, "FILE ERROR " + id + " no such file");
+        return nullptr;
+    }
+    if (token == file->upload_token) {
+        if (upload) file->owner = client_id;
+        return file;
+    }
+    if (!upload && token == file->download_token) {
+        file->recipient = client_id;
+        return file;
+    }
+    client_manager.send_to_client(client_id, "FILE ERROR " + id + " access denied");
+    return nullptr;
+}
 
-    bool send_to_client(int client_id, const std::string& message) {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
+//  :     .  .
+static std::string upload_notice(const StoredFile& file) {
+    return "FILE UPLOAD " + std::to_string(file.id) + " " + std::to_string(file.stored.load()) + " " +
+        file.upload_token + " " + file.name;
+}
 
-        auto it = clients_.find(client_id);
-        if (it == clients_.end()) return false;
+//   ( file_frame):    .
+//     -  ,   .
+static void receive_file_chunk(int client_id, const std::string& message) {
+    file_frame::Chunk chunk;
+    if (!file_frame::decode(message.data(), message.size(), chunk)) return;
+
+    std::shared_ptr<StoredFile> file;
+    std::string id = std::to_string(chunk.transfer);
+    switch (file_store.write(chunk, client_id, file)) {
+    case FileStore::WriteStatus::Written:
+        UploadMetrics::get().bytes.add(chunk.size);
+        break;
+    case FileStore::WriteStatus::Complete:
+        UploadMetrics::get().bytes.add(chunk.size);
+        offer_file(*file);
+        break;
+    case FileStore::WriteStatus::WrongOffset:
+        client_manager.send_to_client(client_id, upload_notice(*file));
+        break;
+    case FileStore::WriteStatus::Unknown:
+        client_manager.send_to_client(client_id, "FILE ERROR " + id + " no such file");
+        break;
+    case FileStore::WriteStatus::Denied:
+        client_manager.send_to_client(client_id, "FILE ERROR " + id + " access denied");
+        break;
+    case FileStore::WriteStatus::Failed:
+        LOG_ERROR("File %s: write failed: %d", id.c_str(), errno);
+        client_manager.send_to_client(client_id, "FILE ERROR " + id + " write failed on server");
+        break;
+    }
+}
 
-        Client& client = it->second;
-        if (!client.connected) return false;
+//  : /sendfile id_  .
+//  - "FILE UPLOAD    ",     file_frame.
+static void command_sendfile(int client_id, std::string_view args) {
+    size_t first_space = args.find(' ');
+    size_t second_space = first_space == std::string_view::npos ? first_space : args.find(' ', first_space + 1);
+    if (second_space == std::string_view::npos) {
+        client_manager.send_to_client(client_id, "Usage: /sendfile 'ID' 'Size' 'Name'");
+        return;
+    }
 
-        return net_utils::send_message(client.socket, message);
+    int recipient = 0;
+    uint64_t size = 0;
+    try {
+        recipient = std::stoi(std::string(args.substr(0, first_space)));
+        size = std::stoull(std::string(args.substr(first_space + 1, second_space - first_space - 1)));
+    }
+    catch (...) {
+        client_manager.send_to_client(client_id, "Usage: /sendfile 'ID' 'Size' 'Name'");
+        return;
+    }
+    if (!client_manager.is_client_connected(recipient)) {
+        client_manager.send_to_client(client_id, "Wrong user ID: " + std::to_string(recipient) + " not found");
+        return;
+    }
+    if (!file_transfers) {
+        client_manager.send_to_client(client_id,
+            "FILE ERROR 0 file transfers need a reactor mode (--epoll or --uring)");
+        return;
     }
-};
 
-ClientManager client_manager;
+    std::string name(args.substr(second_space + 1));
+    std::string error;
+    std::shared_ptr<StoredFile> file = file_store.create(client_id, recipient, name, size, error);
+    if (!file) {
+        client_manager.send_to_client(client_id, "FILE ERROR 0 " + error);
+        return;
+    }
+    client_manager.send_to_client(client_id, upload_notice(*file));
+    if (size == 0) offer_file(*file);
+}
 
-void handle_client_command(int client_id, const std::string& command) {
+//    ,    : /resume  
+static void command_resume(int client_id, std::string_view args) {
+    std::shared_ptr<StoredFile> file = find_file(client_id, args, true);
+    if (!file) return;
+    if (file->complete()) {
+        client_manager.send_to_client(client_id, "FILE STORED " + std::to_string(file->id) + " " +
+            std::to_string(file->size) + " " + file->name);
+        return;
+    }
+    client_manager.send_to_client(client_id, upload_notice(*file));
+}
 
-    //   : /name 
-    if (command.rfind("/name ", 0) == 0) {
-        std::string new_name = command.substr(6);
-        std::string old_name = client_manager.get_client_name(client_id);
-        client_manager.set_client_name(client_id, new_name);
-
-        std::string msg = old_name + " changed name to " + new_name;
-        client_manager.broadcast_message(msg);
-    }
-    //   : /msg id 
-    else if (command.rfind("/msg ", 0) == 0) {
-        size_t space_pos = command.find(' ', 5);
-        if (space_pos != std::string::npos) {
-            std::string target_id_str = command.substr(5, space_pos - 5);
-            std::string private_msg = command.substr(space_pos + 1);
-
-            try {
-                int target_id = std::stoi(target_id_str);
-                std::string full_msg = "[Personally from " + client_manager.get_client_name(client_id) + "]: " + private_msg;
-                client_manager.send_to_client(target_id, full_msg);
-                client_manager.send_to_client(client_id,
-                    "Message sent to user " + target_id_str);
-            }
-            catch (...) {
-                client_manager.send_to_client(client_id,
-                    "Wrong user ID: " + target_id_str + " not found");
-            }
+//  : /getfile   [] -   ,  .
+//       -   .
+static void command_getfile(int client_id, std::string_view args) {
+    size_t token_pos = args.find(' ');
+    size_t space_pos = token_pos == std::string_view::npos ? token_pos : args.find(' ', token_pos + 1);
+    std::shared_ptr<StoredFile> file = find_file(client_id, args.substr(0, space_pos), false);
+    if (!file) return;
+
+    std::string id = std::to_string(file->id);
+    if (!file->complete()) {
+        client_manager.send_to_client(client_id, "FILE ERROR " + id + " upload is not finished");
+        return;
+    }
+    uint64_t offset = 0;
+    if (space_pos != std::string_view::npos) {
+        try {
+            offset = std::stoull(std::string(args.substr(space_pos + 1)));
+        }
+        catch (...) {
         }
     }
-    //   
-    else if (command == "/users") {
-        std::string user_list = "Connected users:\n";
-        auto connected_clients = client_manager.get_connected_clients();
-        for (int id : connected_clients) {
-                user_list += "ID: " + std::to_string(id) +
-                    " - " + client_manager.get_client_name(id) + "\n";
+    if (offset > file->size) offset = file->size;
+
+    // FILE BEGIN    :      
+    std::string begin = "FILE BEGIN " + id + " " + std::to_string(file->size) + " " +
+        std::to_string(offset) + " " + file->name;
+    if (!client_manager.send_file(client_id, begin, file, offset)) {
+        client_manager.send_to_client(client_id,
+            "FILE ERROR " + id + " downloads need a reactor mode (--epoll or --uring)");
+    }
+}
+
+//  
+static void command_help(int client_id, std::string_view) {
+    std::string help =
+        "Availible commands:\n"
+        "/name 'NewName' - changes your name\n"
+        "/msg 'ID' 'Message' - personal message\n"
+        "/users - user list\n"
+        "/join 'Room' - join a room, your messages go there\n"
+        "/leave ['Room'] - leave a room (current by default)\n"
+        "/to 'Room' 'Message' - message to one of your rooms\n"
+        "/rooms - your rooms\n"
+        "/overflow oldest|newest|disconnect - what to do when you can't keep up\n"
+        "/sendfile 'ID' 'Path' - send a file to a user\n"
+        "/resume 'File' ['Token'] 'Path' - continue an interrupted upload (token after a client restart)\n"
+        "/getfile 'File' ['Token'] - download a file offered to you (token after a client restart)\n"
+        "/history ['Count'] - last messages of the common chat\n"
+        "/since 'Seq' - common chat messages after the numbered one\n"
+        "/help - this text\n"
+        "/exit - exit";
+    client_manager.send_to_client(client_id, help);
+}
+
+//   on_client_message,    
+static void command_exit(int, std::string_view) {
+}
+
+using ChatHandler = void (*)(int client_id, std::string_view args);
+
+//    :   -   
+static constexpr auto chat_commands = make_command_table<ChatHandler>({
+    { "/name", command_name },
+    { "/msg", command_msg },
+    { "/users", command_users },
+    { "/overflow", command_overflow },
+    { "/join", command_join },
+    { "/leave", command_leave },
+    { "/to", command_to },
+    { "/rooms", command_rooms },
+    { "/sendfile", command_sendfile },
+    { "/resume", command_resume },
+    { "/getfile", command_getfile },
+    { "/history", command_history },
+    { "/since", command_since },
+    { "/help", command_help },
+    { "/exit", command_exit }
+});
+
+static_assert(chat_commands.find("/help") != nullptr && chat_commands.find("/nope") == nullptr,
+    "chat command table is broken");
+
+//  :    ,  -  
+struct ChatMetrics {
+    MetricsRegistry& registry = MetricsRegistry::instance();
+    Counter& accepted = registry.counter("chat_accepted_total", "Accepted TCP connections");
+    Counter& messages = registry.counter("chat_rx_messages_total", "Frames received from clients");
+    Counter& received_bytes = registry.counter("chat_rx_bytes_total",
+        "Bytes of received frames, length headers included");
+    Histogram& fanout = registry.histogram("chat_fanout_seconds",
+        "From a decoded chat message to its frame handed to every shard");
+    Histogram* commands[chat_commands.size()];  //     
+
+    ChatMetrics() {
+        for (size_t i = 0; i < chat_commands.size(); ++i) {
+            std::string name(chat_commands.entry(i).name);
+            commands[i] = &registry.histogram("chat_command_seconds", "Chat command handling time",
+                "command=\"" + name + "\"");
         }
-        client_manager.send_to_client(client_id, user_list);
-    }
-    //  
-    else if (command == "/help") {
-        std::string help =
-            "Availible commands:\n"
-            "/name 'NewName' - changes your name\n"
-            "/msg 'ID' 'Message' - personal message\n"
-            "/users - user list\n"
-            "/help - this text\n"
-            "/exit - exit";
-        client_manager.send_to_client(client_id, help);
+        registry.observe("chat_clients", "Connected clients", MetricsRegistry::Type::Gauge, "", nullptr,
+            []() { return (double)client_manager.get_client_count(); });
     }
+};
+
+static ChatMetrics& chat_metrics() {
+    static ChatMetrics metrics;
+    return metrics;
 }
 
-void handle_client(int client_id, net_utils::socket_t client_socket, struct sockaddr_in client_addr) {
+void handle_client_command(int client_id, const std::string& command) {
+    //   ,   -  ,  
+    ParsedCommand parsed = parse_command(command);
+    size_t index = chat_commands.index_of(parsed.name);
+    if (index == chat_commands.size()) return;
+
+    uint64_t started = Histogram::now_ns();
+    chat_commands.entry(index).handler(client_id, parsed.args);
+    chat_metrics().commands[index]->record(Histogram::now_ns() - started);
+}
+
+void on_client_connected(int client_id, const struct sockaddr_in& client_addr) {
     //  IP   
     char client_ip[INET_ADDRSTRLEN];
     #ifdef NET_WINDOWS
@@ -208,51 +493,71 @@ void handle_client(int client_id, net_utils::socket_t client_socket, struct sock
     inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, sizeof(client_ip));
     #endif
 
-    std::cout << "Client connected: " << client_ip
-        << ":" << client_manager.get_client_name(client_id)
-        << " (ID: " << std::to_string(client_id) << ")" << std::endl;
+    LOG_INFO("Client connected: %s:%s (ID: %d)", client_ip,
+        client_manager.get_client_name(client_id).c_str(), client_id);
+    chat_metrics().accepted.add();
 
     //  
     std::string welcome =
         "Welcome in chat!\n"
         "Your ID: " + std::to_string(client_id) + "\n"
         "Enter /help for command list";
-    net_utils::send_message(client_socket, welcome);
+    client_manager.send_to_client(client_id, welcome);
+
+    //  -    
+    uint64_t last = history_log.last_seq();
+    if (history_log.enabled() && history_replay_count && last) {
+        replay_history(client_id, last > history_replay_count ? last - history_replay_count : 0,
+            history_replay_count);
+    }
 
     //     
     std::string join_msg = "User " + client_manager.get_client_name(client_id) +
         " connected to chat";
     client_manager.broadcast_message(join_msg, client_id);
+}
 
-    //    
-    while (true) {
-        std::string message = net_utils::read_message(client_socket);
+bool on_client_message(int client_id, const std::string& message) {
+    ChatMetrics& metrics = chat_metrics();
+    metrics.messages.add();
+    metrics.received_bytes.add(message.size() + net_utils::FrameDecoder::HEADER_SIZE);
 
-        //    -  
-        if (message.empty()) {
-            break;
-        }
+    //   -  :   ,   
+    if (file_frame::is_chunk(message.data(), message.size())) {
+        receive_file_chunk(client_id, message);
+        return true;
+    }
 
-        //    
-        std::cout << "[" << client_id << "] " << message << std::endl;
+    //    
+    LOG_INFO("[%d] %.*s", client_id, (int)message.size(), message.data());
 
-        //  
-        if (message[0] == '/') {
-            handle_client_command(client_id, message);
+    //  
+    if (message[0] == '/') {
+        handle_client_command(client_id, message);
+    }
+    else {
+        uint64_t started = Histogram::now_ns();
+        //   -   ,   - 
+        std::string room = client_manager.get_client_room(client_id);
+        std::string formatted_msg = "[" + client_manager.get_client_name(client_id) +
+            "] " + message;
+        if (room.empty()) {
+            //    : ,    /since N
+            uint64_t seq = history_log.append(formatted_msg);
+            client_manager.broadcast_message(seq ? HistoryLog::numbered(seq, formatted_msg) : formatted_msg,
+                client_id);
         }
         else {
-            //   -  
-            std::string formatted_msg = "[" + client_manager.get_client_name(client_id) +
-                "] " + message;
-            client_manager.broadcast_message(formatted_msg, client_id);
-        }
-
-        //   
-        if (message == "/exit") {
-            break;
+            client_manager.room_message(room, "[#" + room + "] " + formatted_msg, client_id);
         }
+        metrics.fanout.record(Histogram::now_ns() - started);
     }
 
+    //   
+    return message != "/exit";
+}
+
+void on_client_disconnected(int client_id) {
     client_manager.disconnect_client(client_id);
 
     //    
@@ -260,13 +565,61 @@ void handle_client(int client_id, net_utils::socket_t client_socket, struct sock
         " left chat";
     client_manager.broadcast_message(leave_msg);
 
+    //     -    
+    client_manager.remove_client(client_id);
+
+    LOG_INFO("Client disconnected: ID %d", client_id);
+}
+
+//   :    
+void handle_client(int client_id, net_utils::socket_t client_socket, struct sockaddr_in client_addr,
+    size_t max_frame_size, uint64_t idle_timeout_ms) {
+    on_client_connected(client_id, client_addr);
+
+    TimerWheel::Handle idle_timer = TimerWheel::NONE;
+    if (idle_timeout_ms) {
+        std::lock_guard<std::mutex> lock(idle_mutex);
+        idle_timer = idle_timers.arm(client_id, idle_timeout_ms, TimerWheel::now_ms());
+    }
+
+    //  recv     
+    net_utils::FrameDecoder decoder(max_frame_size);
+    std::string message;
+
+    //    
+    while (true) {
+        //     -  
+        if (decoder.receive(client_socket, message) != net_utils::ReadStatus::Ok) {
+            break;
+        }
+
+        if (idle_timeout_ms) {
+            std::lock_guard<std::mutex> lock(idle_mutex);
+            idle_timers.rearm(idle_timer, idle_timeout_ms, TimerWheel::now_ms());
+        }
+
+        if (message.empty()) {
+            continue;
+        }
+
+        if (!on_client_message(client_id, message)) {
+            break;
+        }
+    }
+
+    on_client_disconnected(client_id);
+
+    //   :           
+    if (idle_timeout_ms) {
+        std::lock_guard<std::mutex> lock(idle_mutex);
+        idle_timers.cancel(idle_timer);
+    }
+
     //  
     net_utils::socket_close(client_socket);
-
-    std::cout << "Client disconnected: ID " << client_id << std::endl;
 }
 
-net_utils::socket_t startListening(int port = 12345) {
+net_utils::socket_t startListening(int port, bool reuse_port) {
 #ifdef _WIN32
     //  UTF-8   Windows
     SetConsoleOutputCP(CP_UTF8);
@@ -284,7 +637,7 @@ net_utils::socket_t startListening(int port = 12345) {
     //    ( Windows )
     if (!net_utils::net_init()) {
         std::cerr << "Network init failed!" << std::endl;
-        return 1;
+        return net_utils::INVALID_SOCKET_VAL;
     }
 
     //  
@@ -292,8 +645,20 @@ net_utils::socket_t startListening(int port = 12345) {
     if (serverSocket == net_utils::INVALID_SOCKET_VAL) {
         std::cerr << "Error socket initialization: " << net_utils::get_last_error() << std::endl;
         net_utils::net_cleanup();
-        return 1;
+        return net_utils::INVALID_SOCKET_VAL;
+    }
+
+    //   ,     TIME_WAIT
+    int reuse = 1;
+    setsockopt(serverSocket, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+
+    #ifdef NET_LINUX
+    //     :    
+    if (reuse_port &&
+        setsockopt(serverSocket, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse)) != 0) {
+        std::cerr << "SO_REUSEPORT failed: " << net_utils::get_last_error() << std::endl;
     }
+    #endif
 
     //   
     sockaddr_in serverAddr;
@@ -307,28 +672,146 @@ net_utils::socket_t startListening(int port = 12345) {
         std::cerr << "Bind failed: " << net_utils::get_last_error() << std::endl;
         net_utils::socket_close(serverSocket);
         net_utils::net_cleanup();
-        return 1;
+        return net_utils::INVALID_SOCKET_VAL;
     }
 
     //   
-    if (listen(serverSocket, 10) == SOCKET_ERROR_VAL) {
+    if (listen(serverSocket, SOMAXCONN) == SOCKET_ERROR_VAL) {
         std::cerr << "Error listen: " << net_utils::get_last_error() << std::endl;
         net_utils::socket_close(serverSocket);
         net_utils::net_cleanup();
-        return 1;
+        return net_utils::INVALID_SOCKET_VAL;
     }
 
-    std::cout << "Server started. Waiting for connection to port 12345..." << std::endl;
+    std::cout << "Server started. Waiting for connection to port " << port << "..." << std::endl;
 
     return serverSocket;
 }
 
-int runServer() {
+#ifdef NET_LINUX
+//  :        .
+//    ( io_uring) -  ,   .
+template <typename Reactor>
+static int runReactors(const ServerConfig& config) {
+    file_transfers = true;
+    int count = std::max(1, config.reactors);
+    int cpu_count = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<std::unique_ptr<Reactor>> reactors;
+    std::vector<ClientShard*> shards;
+    std::vector<net_utils::socket_t> listen_sockets;
+    for (int i = 0; i < count; ++i) {
+        net_utils::socket_t listen_socket = startListening(config.port, count > 1);
+        if (listen_socket == net_utils::INVALID_SOCKET_VAL) {
+            reactors.clear();
+            for (net_utils::socket_t opened : listen_sockets) net_utils::socket_close(opened);
+            std::cerr << "Cannot listen on port " << config.port << ", server is not started" << std::endl;
+            return 1;
+        }
+        listen_sockets.push_back(listen_socket);
+        try {
+            reactors.emplace_back(new Reactor(listen_socket, i, config.max_frame_size,
+                config.idle_timeout_ms));
+        }
+        catch (const std::runtime_error&) {
+            reactors.clear();
+            for (net_utils::socket_t opened : listen_sockets) net_utils::socket_close(opened);
+            throw;
+        }
+        shards.push_back(reactors.back().get());
+    }
+    client_manager.attach_shards(shards);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < count; ++i) {
+        threads.emplace_back([&, i]() {
+            if (config.pin_threads && !pin_current_thread(i % cpu_count)) {
+                std::cerr << "Failed to pin reactor #" << i << std::endl;
+            }
+            reactors[i]->run();
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    reactors.clear();
+    for (net_utils::socket_t listen_socket : listen_sockets) {
+        net_utils::socket_close(listen_socket);
+    }
+    net_utils::net_cleanup();
+    return 0;
+}
+#endif
+
+int runServer(const ServerConfig& config) {
+
+    client_manager.set_queue_limits(config.queue_limits);
+    if (!file_store.configure(config.file_directory, config.file_limits)) {
+        std::cerr << "File directory " << config.file_directory << " is not available, /sendfile will fail"
+            << std::endl;
+    }
+    std::string history_error;
+    if (history_log.open(config.history, history_error)) {
+        history_replay_count = config.history.replay_count;
+        std::cout << "History: " << config.history.directory << ", messages #" << history_log.first_seq()
+            << "-#" << history_log.last_seq() << std::endl;
+    }
+    else if (!history_error.empty()) {
+        std::cerr << "History is off: " << history_error << std::endl;
+    }
+
+    if (config.mode == ServerMode::Uring) {
+        #ifdef NET_URING
+        try {
+            return runReactors<UringReactor>(config);
+        }
+        catch (const std::runtime_error& e) {
+            std::cerr << "io_uring is not available (" << e.what() << "), using epoll" << std::endl;
+        }
+        #else
+        std::cerr << "io_uring is not available, using epoll" << std::endl;
+        #endif
+    }
+
+    if (config.mode == ServerMode::Epoll || config.mode == ServerMode::Uring) {
+        #ifdef NET_LINUX
+        return runReactors<EpollReactor>(config);
+        #else
+        std::cerr << "epoll is not available, using threaded mode" << std::endl;
+        #endif
+    }
+
+    if (config.queue_limits.zerocopy_threshold > 0) {
+        std::cerr << "Zero-copy sends need the epoll reactor, sending by copy" << std::endl;
+    }
 
-    net_utils::socket_t serverSocket = startListening(12345);
+    net_utils::socket_t serverSocket = startListening(config.port);
+    if (serverSocket == net_utils::INVALID_SOCKET_VAL) {
+        std::cerr << "Cannot listen on port " << config.port << ", server is not started" << std::endl;
+        return 1;
+    }
 
     std::vector<std::thread> client_threads;
 
+    if (config.idle_timeout_ms) {
+        std::thread([]() {
+            while (true) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(idle_timers.tick_ms()));
+
+                std::lock_guard<std::mutex> lock(idle_mutex);
+                idle_timers.advance(TimerWheel::now_ms(), [](uint64_t client_id) {
+                    //     recv    
+                    net_utils::socket_t sock = client_manager.get_client_socket((int)client_id);
+                    if (sock == net_utils::INVALID_SOCKET_VAL) return;
+                    LOG_INFO("Idle timeout: client %d", (int)client_id);
+                    net_utils::shutdown(sock);
+                });
+            }
+        }).detach();
+    }
+
     while (true) {
 
         struct sockaddr_in client_addr;
@@ -343,20 +826,26 @@ int runServer() {
             &client_len);
 
         if (client_socket == net_utils::INVALID_SOCKET_VAL) {
-            std::cerr << "Error accept: " << net_utils::get_last_error() << std::endl;
+            LOG_ERROR("Error accept: %d", net_utils::get_last_error());
             continue;
         }
 
         //    
         int client_id = client_manager.add_client(client_socket, client_addr);
+        if (!client_id) {
+            LOG_WARN("Client table is full, connection rejected");
+            net_utils::socket_close(client_socket);
+            continue;
+        }
 
         //     
-        client_threads.emplace_back(handle_client, client_id, client_socket, client_addr);
+        client_threads.emplace_back(handle_client, client_id, client_socket, client_addr,
+            config.max_frame_size, config.idle_timeout_ms);
 
         //   (  )
         client_threads.back().detach();
 
-        std::cout << "Total clients: " << client_manager.get_client_count() << std::endl;
+        LOG_INFO("Total clients: %zu", client_manager.get_client_count());
     }
     net_utils::socket_close(serverSocket);
 
@@ -1,4 +1,36 @@
 #pragma once
+#include "../Common/net_utils.h"
+#include "OutboundQueue.h"
+#include "HistoryLog.h"
+#include "FileStore.h"
+#include <string>
 
+//   TCP-
+enum class ServerMode {
+    Threaded,   //    
+    Epoll,      //   epoll ( Linux)
+    Uring       //   io_uring (Linux 5.19+,  epoll)
+};
 
-int runServer();
\ No newline at end of file
+struct ServerConfig {
+    ServerMode mode = ServerMode::Threaded;
+    int port = 12345;
+    int reactors = 1;           //   ()   Epoll  Uring
+    bool pin_threads = false;   //    
+    QueueLimits queue_limits;   //    
+    size_t max_frame_size = net_utils::MAX_FRAME_SIZE;  //  -  
+    uint64_t idle_timeout_ms = 0;   //    (0 -  )
+    std::string file_directory = "files";   //  /sendfile  
+    FileLimits file_limits;                 // ,     
+    HistoryConfig history;                  //      
+};
+
+int runServer(const ServerConfig& config = ServerConfig());
+
+net_utils::socket_t startListening(int port = 12345, bool reuse_port = false);
+
+//   ,    
+void handle_client_command(int client_id, const std::string& command);
+void on_client_connected(int client_id, const struct sockaddr_in& client_addr);
+bool on_client_message(int client_id, const std::string& message);   // false -  
+void on_client_disconnected(int client_id);
\ No newline at end of file
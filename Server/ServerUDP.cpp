@@ -1,45 +1,154 @@
 #include "ServerUDP.h"
-#include <sstream>
+#include "CommandTable.h"
+#include "Logger.h"
 #include <iomanip>
-UdpRadioServer::UdpRadioServer() {
+#include <algorithm>
+#include <cstring>
+static size_t clamp_workers(size_t workers, size_t max_workers) {
+    return std::max<size_t>(1, std::min(workers, max_workers));
+}
+
+UdpRadioServer::UdpRadioServer(const UdpServerConfig& config)
+    : config_(config), buffers_(clamp_workers(config.workers, MAX_WORKERS)),
+    received_(MetricsRegistry::instance().counter("radio_commands_received_total",
+        "Datagrams received on the command port, NACKs included")),
+    responses_(MetricsRegistry::instance().counter("radio_responses_total", "Responses sent")),
+    received_bytes_(MetricsRegistry::instance().counter("radio_rx_bytes_total",
+        "Bytes received on the command port")),
+    response_bytes_(MetricsRegistry::instance().counter("radio_tx_bytes_total",
+        "Bytes sent by kind", "kind=\"response\"")),
+    registered_(MetricsRegistry::instance().counter("radio_clients_registered_total",
+        "Clients seen for the first time (or again after expiry)")),
+    receive_batch_(MetricsRegistry::instance().histogram("radio_receive_batch",
+        "Datagrams returned by one batched receive", "", 1)),
+    syscalls_(nullptr),
+    history_(config.retransmit_window, RADIO_SLOT_SIZE, config.retransmit_rate) {
+        config_.workers = clamp_workers(config_.workers, MAX_WORKERS);
+        register_metrics();
+
         if (!net_utils::net_init()) {
             throw std::runtime_error("Network init failed");
         }
 
-        //       
-        server_socket_ = net_utils::create_udp_socket();
-        if (server_socket_ == net_utils::INVALID_SOCKET_VAL) {
-            throw std::runtime_error("Socket creation failed");
+        #ifdef NET_LINUX
+        size_t socket_count = config_.workers;
+        #else
+        size_t socket_count = 1;    //  SO_REUSEPORT -    
+        #endif
+
+        for (size_t i = 0; i < socket_count; ++i) {
+            //       
+            net_utils::socket_t sock = net_utils::create_udp_socket();
+            if (sock == net_utils::INVALID_SOCKET_VAL) {
+                for (net_utils::socket_t opened : sockets_) net_utils::socket_close(opened);
+                throw std::runtime_error("Socket creation failed");
+            }
+
+            #ifdef NET_LINUX
+            //     :      
+            int reuse = 1;
+            if (socket_count > 1 &&
+                setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse)) != 0) {
+                std::cerr << "SO_REUSEPORT failed: " << net_utils::get_last_error() << std::endl;
+            }
+            #endif
+
+            //     
+            if (!net_utils::bind_socket(sock, RESPONSE_PORT)) {
+                net_utils::socket_close(sock);
+                for (net_utils::socket_t opened : sockets_) net_utils::socket_close(opened);
+                throw std::runtime_error("Bind failed");
+            }
+
+            //     ,     
+            net_utils::set_timeout(sock, 100);
+            sockets_.push_back(sock);
         }
 
-        //     
-        if (!net_utils::bind_socket(server_socket_, RESPONSE_PORT)) {
-            net_utils::socket_close(server_socket_);
-            throw std::runtime_error("Bind failed");
+        // io_uring:   .     -    .
+        const char* backend = config_.batch_size > 1 ? "batch" : "sync";
+        if (config_.uring) {
+            #ifdef NET_URING
+            try {
+                Counter& uring_calls = MetricsRegistry::instance().counter("radio_io_syscalls_total",
+                    "System calls made on the command port", "backend=\"uring\"");
+                for (size_t i = 0; i < config_.workers; ++i) {
+                    uring_workers_.emplace_back(new UringWorker(&uring_calls));
+                }
+                backend = "uring";
+            }
+            catch (const std::runtime_error& e) {
+                uring_workers_.clear();
+                config_.uring = false;
+                std::cerr << "io_uring is not available (" << e.what() << "), using "
+                    << backend << " receive" << std::endl;
+            }
+            #else
+            config_.uring = false;
+            std::cerr << "io_uring is not available, using " << backend << " receive" << std::endl;
+            #endif
         }
+        syscalls_ = &MetricsRegistry::instance().counter("radio_io_syscalls_total",
+            "System calls made on the command port", std::string("backend=\"") + backend + "\"");
 
-        //  broadcast  
-        if (!net_utils::enable_broadcast(server_socket_)) {
-            std::cerr << "Warning: Broadcast not enabled" << std::endl;
+        if (config_.multicast_group.empty()) {
+            //  broadcast  
+            if (!net_utils::enable_broadcast(sockets_[0])) {
+                std::cerr << "Warning: Broadcast not enabled" << std::endl;
+            }
+            net_utils::make_address("255.255.255.255", BROADCAST_PORT, broadcast_target_);
+        }
+        else {
+            // Multicast:     
+            if (!net_utils::make_address(config_.multicast_group.c_str(), BROADCAST_PORT, broadcast_target_) ||
+                !IN_MULTICAST(ntohl(broadcast_target_.sin_addr.s_addr))) {
+                for (net_utils::socket_t opened : sockets_) net_utils::socket_close(opened);
+                throw std::runtime_error("Invalid multicast group: " + config_.multicast_group);
+            }
+            if (!net_utils::set_multicast_options(sockets_[0], config_.multicast_ttl,
+                config_.multicast_loopback)) {
+                std::cerr << "Warning: multicast options failed: " << net_utils::get_last_error() << std::endl;
+            }
         }
 
         std::cout << "UDP Radio Server started" << std::endl;
-        std::cout << "Broadcast port: " << BROADCAST_PORT << std::endl;
+        std::cout << "Broadcast port: " << BROADCAST_PORT;
+        if (!config_.multicast_group.empty()) {
+            std::cout << " (multicast " << config_.multicast_group
+                << ", ttl " << config_.multicast_ttl << ")";
+        }
+        std::cout << ", rate: " << config_.tick_rate << "/s" << std::endl;
         std::cout << "Response port: " << RESPONSE_PORT << std::endl;
+        std::cout << "Workers: " << config_.workers << ", sockets: " << sockets_.size()
+            << ", batch size: " << config_.batch_size << (config_.uring ? ", io_uring" : "") << std::endl;
     }
 
 UdpRadioServer::~UdpRadioServer() {
+        MetricsRegistry::instance().remove_owner(this);
         stop();
-        net_utils::socket_close(server_socket_);
+        for (net_utils::socket_t sock : sockets_) {
+            net_utils::socket_close(sock);
+        }
         net_utils::net_cleanup();
     }
 
     void UdpRadioServer::start() {
+        start_time_ = std::chrono::steady_clock::now();
+
         //   
         broadcast_thread_ = std::thread(&UdpRadioServer::broadcast_loop, this);
 
-        //   
-        receive_thread_ = std::thread(&UdpRadioServer::receive_loop, this);
+        //   
+        for (size_t i = 0; i < config_.workers; ++i) {
+            #ifdef NET_URING
+            if (config_.uring) {
+                receive_threads_.emplace_back(&UdpRadioServer::receive_uring, this, i);
+                continue;
+            }
+            #endif
+            receive_threads_.emplace_back(config_.batch_size > 1 ?
+                &UdpRadioServer::receive_batched : &UdpRadioServer::receive_loop, this, i);
+        }
 
         std::cout << "Server started. Press Enter to stop..." << std::endl;
         std::cout << "Available commands from clients:" << std::endl;
@@ -62,194 +171,718 @@ UdpRadioServer::~UdpRadioServer() {
             broadcast_thread_.join();
         }
 
-        if (receive_thread_.joinable()) {
-            receive_thread_.join();
+        for (auto& thread : receive_threads_) {
+            if (thread.joinable()) {
+                thread.join();
+            }
         }
 
+        Logger::instance().flush();
         std::cout << "\nServer stopped." << std::endl;
         std::cout << "Broadcast messages: " << broadcast_count_ << std::endl;
-        std::cout << "Received commands: " << received_count_ << std::endl;
-        std::cout << "Sent responses: " << response_count_ << std::endl;
-        std::cout << "Active clients: " << clients_.size() << std::endl;
+        std::cout << "Retransmissions: " << retransmitted_ << " (limited " << retransmit_limited_
+            << ", expired " << retransmit_missing_ << "), overhead "
+            << get_retransmit_overhead() << "%" << std::endl;
+        RateTicker::Stats jitter = get_jitter();
+        std::cout << "Broadcast jitter: mean " << jitter.mean_us << " us, stddev "
+            << jitter.stddev_us << " us, max " << jitter.max_us << " us, missed ticks "
+            << jitter.missed << std::endl;
+        std::cout << "Received commands: " << get_received_count() << std::endl;
+        std::cout << "Sent responses: " << get_response_count() << std::endl;
+        long long received = get_received_count();
+        std::cout << "I/O syscalls: " << syscalls_->value() << " ("
+            << std::fixed << std::setprecision(2)
+            << (received ? (double)syscalls_->value() / received : 0.0) << " per command)"
+            << std::defaultfloat << std::endl;
+        std::cout << "Active clients: " << get_client_count() << std::endl;
     }
 
-    //     
-    std::string UdpRadioServer::generate_broadcast_data() {
+    //     ,     
+    void UdpRadioServer::register_metrics() {
+        MetricsRegistry& registry = MetricsRegistry::instance();
+        for (size_t i = 0; i < LATENCY_SLOTS; ++i) {
+            const char* name = i + 1 < LATENCY_SLOTS ?
+                radio_frame::type_name((uint8_t)(radio_frame::HELLO + i)) : "UNKNOWN";
+            command_latency_[i] = &registry.histogram("radio_command_seconds",
+                "Command handling time, text and binary", std::string("command=\"") + name + "\"");
+        }
+
+        using Type = MetricsRegistry::Type;
+        registry.observe("radio_broadcasts_total", "Broadcast ticks sent", Type::Counter, "", this,
+            [this]() { return (double)broadcast_count_.load(); });
+        registry.observe("radio_tx_bytes_total", "Bytes sent by kind", Type::Counter,
+            "kind=\"broadcast\"", this, [this]() { return (double)broadcast_bytes_.load(); });
+        registry.observe("radio_tx_bytes_total", "Bytes sent by kind", Type::Counter,
+            "kind=\"retransmit\"", this, [this]() { return (double)retransmit_bytes_.load(); });
+        registry.observe("radio_retransmits_total", "Broadcasts resent on NACK", Type::Counter, "", this,
+            [this]() { return (double)retransmitted_.load(); });
+        registry.observe("radio_retransmits_refused_total", "NACKed broadcasts not resent",
+            Type::Counter, "reason=\"limited\"", this, [this]() { return (double)retransmit_limited_.load(); });
+        registry.observe("radio_retransmits_refused_total", "NACKed broadcasts not resent",
+            Type::Counter, "reason=\"expired\"", this, [this]() { return (double)retransmit_missing_.load(); });
+        registry.observe("radio_clients", "Known clients", Type::Gauge, "", this,
+            [this]() { return (double)get_client_count(); });
+        registry.observe("radio_tick_jitter_seconds", "Broadcast tick lateness", Type::Gauge,
+            "stat=\"mean\"", this, [this]() { return get_jitter().mean_us * 1e-6; });
+        registry.observe("radio_tick_jitter_seconds", "Broadcast tick lateness", Type::Gauge,
+            "stat=\"max\"", this, [this]() { return get_jitter().max_us * 1e-6; });
+        registry.observe("radio_missed_ticks_total", "Broadcast ticks skipped after a stall",
+            Type::Counter, "", this, [this]() { return (double)get_jitter().missed; });
+    }
+
+    //     :   
+    //    .    out (RADIO_SLOT_SIZE ),  .
+    size_t UdpRadioServer::build_broadcast(uint32_t seq, char* out) {
         static std::random_device rd;
         static std::mt19937 gen(rd());
         static std::uniform_int_distribution<> dis(1000, 9999);
 
         auto now = std::chrono::system_clock::now();
-        auto time = std::chrono::system_clock::to_time_t(now);
+        char* payload = out + net_utils::RADIO_HEADER_SIZE;
+
+        if (config_.binary_radio) {
+            net_utils::write_radio_header(out, seq, net_utils::RADIO_BINARY);
+            radio_frame::Tick tick;
+            tick.time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                now.time_since_epoch()).count();
+            tick.data = dis(gen);
+            tick.clients = (uint32_t)get_client_count();
+            return net_utils::RADIO_HEADER_SIZE +
+                radio_frame::encode_tick(payload, tick, config_.radio_checksum);
+        }
 
-        std::string data = "[RADIO] Time: ";
+        net_utils::write_radio_header(out, seq, 0);
+        size_t capacity = RADIO_SLOT_SIZE - net_utils::RADIO_HEADER_SIZE;
+        auto time = std::chrono::system_clock::to_time_t(now);
         struct tm time_info;
         localtime_s(&time_info, &time);
-        std::ostringstream oss;
-        oss << std::put_time(&time_info, "%Y-%m-%d %H:%M:%S");
-        data += oss.str();
-        data.pop_back(); //  \n
-        data += " | Data: " + std::to_string(dis(gen));
-        data += " | Seq: " + std::to_string(broadcast_count_);
-        data += " | Clients: " + std::to_string(get_client_count());
-
-        return data;
+        size_t length = strftime(payload, capacity, "[RADIO] Time: %Y-%m-%d %H:%M:%S", &time_info);
+        int rest = snprintf(payload + length, capacity - length, " | Data: %d | Seq: %u | Clients: %zu",
+            dis(gen), seq, get_client_count());
+        if (rest > 0) length += std::min<size_t>(rest, capacity - length - 1);
+        return net_utils::RADIO_HEADER_SIZE + length;
     }
 
     //   ()
     void UdpRadioServer::broadcast_loop() {
         std::cout << "Broadcast thread started" << std::endl;
 
-        while (running_) {
-            //    
-            std::string broadcast_data = generate_broadcast_data();
-
-            //  broadcast   
-            if (net_utils::send_broadcast(server_socket_, broadcast_data, BROADCAST_PORT)) {
-                broadcast_count_++;
+        RateTicker ticker(config_.tick_rate);
+        //     10 ,       
+        long long log_every = std::max<long long>(10, (long long)(config_.tick_rate * 10));
+        uint64_t ticks_per_expiry = std::max<uint64_t>(1,
+            (uint64_t)(config_.tick_rate * clients_[0].timers.tick_ms() / 1000));
+        uint64_t tick = 0;
 
-                //   10- 
-                if (broadcast_count_ % 10 == 0) {
-                    std::cout << "Broadcast #" << broadcast_count_
-                        << ": " << broadcast_data.substr(0, 40) << "..." << std::endl;
+        char packet[RADIO_SLOT_SIZE];
+        while (running_) {
+            //   ,     
+            uint32_t seq = (uint32_t)broadcast_count_.load() + 1;
+            size_t size = build_broadcast(seq, packet);
+            history_.store(seq, packet, size);
+
+            //  broadcast (  )   
+            if (net_utils::send_udp_to(sockets_[0], packet, size, broadcast_target_)) {
+                long long count = ++broadcast_count_;
+                broadcast_bytes_ += size;
+
+                if (count % log_every == 0) {
+                    if (config_.binary_radio) {
+                        LOG_INFO("Broadcast #%lld: binary tick, %zu bytes", count, size);
+                    }
+                    else {
+                        LOG_INFO("Broadcast #%lld: %.*s...", count,
+                            (int)std::min<size_t>(40, size - net_utils::RADIO_HEADER_SIZE),
+                            packet + net_utils::RADIO_HEADER_SIZE);
+                    }
                 }
             }
 
-            if (broadcast_count_ % 30 == 0) {
-                cleanup_inactive_clients();
+            if (++tick % ticks_per_expiry == 0) {
+                //   ,    
+                expire_idle_clients();
+
+                std::lock_guard<std::mutex> lock(jitter_mutex_);
+                jitter_ = ticker.stats();
             }
 
-            //  1   
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+            //    :    
+            ticker.wait();
         }
 
+        std::lock_guard<std::mutex> lock(jitter_mutex_);
+        jitter_ = ticker.stats();
+
         std::cout << "Broadcast thread stopped" << std::endl;
     }
 
+    // NACK   :      
+    static bool is_nack(const net_utils::UdpBuffer& packet) {
+        return packet.size > 5 && memcmp(packet.data, "NACK ", 5) == 0;
+    }
+
     //     
-    void UdpRadioServer::receive_loop() {
-        std::cout << "Receive thread started" << std::endl;
+    void UdpRadioServer::receive_loop(size_t worker) {
+        std::cout << "Receive thread #" << worker << " started" << std::endl;
+
+        net_utils::socket_t sock = sockets_[worker % sockets_.size()];
+
+        //        -     
+        net_utils::UdpBuffer* packet = buffers_.acquire();
+        std::string response;
+        response.reserve(1024);
 
         while (running_) {
-            //     
-            net_utils::UdpPacket packet;
-            if (net_utils::receive_udp_with_timeout(server_socket_, packet, 100)) {
-                received_count_++;
-                process_command(packet);
+            //    (    )
+            bool got = net_utils::receive_udp_into(sock, *packet);
+            syscalls_->add();
+            if (got) {
+                received_.add();
+                received_bytes_.add(packet->size);
+                if (is_nack(*packet)) {
+                    handle_nack(sock, *packet);
+                    continue;
+                }
+
+                response.clear();
+                sockaddr_in target = packet->sender;
+                target.sin_port = htons(process_command(*packet, response));
+
+                //     
+                char address[net_utils::ADDRESS_STRLEN];
+                syscalls_->add();
+                if (net_utils::send_udp_to(sock, response.data(), response.size(), target)) {
+                    responses_.add();
+                    response_bytes_.add(response.size());
+                    LOG_DEBUG("Response sent to %s",
+                        net_utils::format_address(target, address, sizeof(address)));
+                }
+                else {
+                    LOG_WARN("Failed to send response to %s",
+                        net_utils::format_address(target, address, sizeof(address)));
+                }
             }
         }
 
+        buffers_.release(packet);
         std::cout << "Receive thread stopped" << std::endl;
     }
 
-    //   
-    void UdpRadioServer::process_command(const net_utils::UdpPacket& packet) {
-        //    
-        std::string command = packet.data;
-        int response_port = packet.sender_port; //    
+    //  :     recvmmsg,   -  sendmmsg
+    void UdpRadioServer::receive_batched(size_t worker) {
+        std::cout << "Receive thread #" << worker << " started (batch "
+            << config_.batch_size << ")" << std::endl;
 
-        //      (: "COMMAND <port>")
-        size_t last_space = command.find_last_of(' ');
-        if (last_space != std::string::npos) {
-            try {
-                response_port = std::stoi(command.substr(last_space + 1));
-                command = command.substr(0, last_space);
+        net_utils::socket_t sock = sockets_[worker % sockets_.size()];
+
+        net_utils::UdpReceiveBatch incoming(config_.batch_size);
+        net_utils::UdpSendBatch responses(config_.batch_size);
+        std::string response;
+        response.reserve(1024);
+
+        while (running_) {
+            // poll,  recvmmsg -    
+            int received = incoming.receive(sock, 100);
+            syscalls_->add(received > 0 ? 2 : 1);
+            if (received <= 0) continue;
+            received_.add(received);
+            receive_batch_.record(received);
+
+            for (int i = 0; i < received; ++i) {
+                const net_utils::UdpBuffer& packet = incoming.packet(i);
+                received_bytes_.add(packet.size);
+                if (is_nack(packet)) {
+                    handle_nack(sock, packet);
+                    continue;
+                }
+
+                response.clear();
+                sockaddr_in target = packet.sender;
+                target.sin_port = htons(process_command(packet, response));
+                responses.add(response, target);
             }
-            catch (...) {
-                //   ,   
+
+            size_t queued = responses.count();
+            size_t sent_bytes = 0;
+            size_t sent = responses.flush(sock, &sent_bytes);
+            if (queued) syscalls_->add();   //   sendmmsg  
+            responses_.add(sent);
+            response_bytes_.add(sent_bytes);
+            if (sent < queued) {
+                LOG_WARN("Failed to send %zu responses", queued - sent);
             }
         }
 
-        {
-            std::lock_guard<std::mutex> lock(clients_mutex_);
-            clients_[packet.sender_ip] = {
-                command,
-                response_port,
-                std::chrono::system_clock::now()
-            };
+        std::cout << "Receive thread stopped" << std::endl;
+    }
+
+    #ifdef NET_URING
+    // io_uring:  multishot- recvmsg    ,  
+    //       .  -  sendmsg,   
+    //       .
+    void UdpRadioServer::receive_uring(size_t worker) {
+        std::cout << "Receive thread #" << worker << " started (io_uring)" << std::endl;
+
+        net_utils::socket_t sock = sockets_[worker % sockets_.size()];
+        IoUring& ring = uring_workers_[worker]->ring;
+        ProvidedBuffers& buffers = uring_workers_[worker]->buffers;
+
+        //   : ,        
+        struct ResponseSlot {
+            std::string data;
+            sockaddr_in target;
+            iovec slice;
+            msghdr message;
+        };
+        std::vector<ResponseSlot> slots(URING_SLOTS);
+        std::vector<uint32_t> free_slots;
+        for (uint32_t i = 0; i < URING_SLOTS; ++i) {
+            slots[i].data.reserve(1024);
+            free_slots.push_back(i);
         }
 
-        auto now = std::chrono::system_clock::now();
-        auto time = std::chrono::system_clock::to_time_t(now);
-        struct tm time_info;
-        localtime_s(&time_info, &time);
+        //   multishot recvmsg:        
+        const uint64_t RECEIVE = UINT64_MAX;
+        msghdr receive_header = {};
+        receive_header.msg_namelen = sizeof(sockaddr_in);
+        auto arm_receive = [&]() {
+            io_uring_sqe* entry = ring.sqe();
+            entry->opcode = IORING_OP_RECVMSG;
+            entry->fd = sock;
+            entry->addr = (uint64_t)(uintptr_t)&receive_header;
+            entry->ioprio = IORING_RECV_MULTISHOT;
+            entry->flags = IOSQE_BUFFER_SELECT;
+            entry->buf_group = buffers.group();
+            entry->user_data = RECEIVE;
+        };
+        arm_receive();
+
+        net_utils::UdpBuffer packet;
+        size_t batch = 0;
+        auto on_completion = [&](const io_uring_cqe& cqe) {
+            if (cqe.user_data != RECEIVE) {
+                //   ( ) -  
+                if (cqe.res >= 0) {
+                    responses_.add();
+                    response_bytes_.add(cqe.res);
+                }
+                else {
+                    LOG_WARN("Failed to send response: %d", -cqe.res);
+                }
+                free_slots.push_back((uint32_t)cqe.user_data);
+                return;
+            }
 
-        std::cout << "\n[" << std::put_time(&time_info, "%H:%M:%S") << "] "
-            << packet.sender_ip << ":" << packet.sender_port
-            << " -> " << command
-            << " (response port: " << response_port << ")" << std::endl;
+            //   ( , ) -  
+            if (!(cqe.flags & IORING_CQE_F_MORE) && running_) arm_receive();
+            if (!(cqe.flags & IORING_CQE_F_BUFFER)) return;
 
-        //  
-        std::string response;
+            // :  io_uring_recvmsg_out,  , 
+            uint16_t id = ProvidedBuffers::id_of(cqe);
+            char* data = buffers.data(id);
+            if (cqe.res < 0) {
+                buffers.put(id);
+                return;
+            }
+            const io_uring_recvmsg_out* out = (const io_uring_recvmsg_out*)data;
+            size_t header = sizeof(io_uring_recvmsg_out) + receive_header.msg_namelen;
+            memset(&packet.sender, 0, sizeof(packet.sender));
+            memcpy(&packet.sender, data + sizeof(io_uring_recvmsg_out),
+                std::min<size_t>(out->namelen, sizeof(packet.sender)));
+            packet.data = data + header;
+            packet.capacity = buffers.size() - header;
+            packet.size = std::min<size_t>(out->payloadlen, packet.capacity);
+
+            ++batch;
+            received_.add();
+            received_bytes_.add(packet.size);
+            if (is_nack(packet)) {
+                handle_nack(sock, packet);
+            }
+            else if (free_slots.empty()) {
+                //     -   ,  
+                LOG_WARN("No free response slot, response dropped");
+            }
+            else {
+                uint32_t index = free_slots.back();
+                free_slots.pop_back();
+                ResponseSlot& slot = slots[index];
+                slot.data.clear();
+                slot.target = packet.sender;
+                slot.target.sin_port = htons(process_command(packet, slot.data));
+                slot.slice.iov_base = &slot.data[0];
+                slot.slice.iov_len = slot.data.size();
+                slot.message = {};
+                slot.message.msg_name = &slot.target;
+                slot.message.msg_namelen = sizeof(slot.target);
+                slot.message.msg_iov = &slot.slice;
+                slot.message.msg_iovlen = 1;
+
+                io_uring_sqe* entry = ring.sqe();
+                entry->opcode = IORING_OP_SENDMSG;
+                entry->fd = sock;
+                entry->addr = (uint64_t)(uintptr_t)&slot.message;
+                entry->msg_flags = MSG_NOSIGNAL;
+                entry->user_data = index;
+            }
+            buffers.put(id);
+        };
+
+        while (running_) {
+            //      -  
+            ring.submit(1, 100);
+            batch = 0;
+            ring.drain(on_completion);
+            if (batch) receive_batch_.record(batch);
+        }
+
+        //   :  ,    
+        for (int i = 0; i < 10 && free_slots.size() < URING_SLOTS; ++i) {
+            ring.submit(1, 100);
+            ring.drain(on_completion);
+        }
+
+        std::cout << "Receive thread stopped" << std::endl;
+    }
+    #endif
+
+    //    "COMMAND <port>"; false -   
+    static bool parse_port(const char* text, size_t length, int& port) {
+        if (length == 0 || length > 5) return false;
+        int value = 0;
+        for (size_t i = 0; i < length; ++i) {
+            if (text[i] < '0' || text[i] > '9') return false;
+            value = value * 10 + (text[i] - '0');
+        }
+        if (value == 0 || value > 65535) return false;
+        port = value;
+        return true;
+    }
 
-        //  
-        if (command == "HELLO") {
-            response = "WELCOME to UDP Radio Server! Your response port: " +
-                std::to_string(response_port) +
-                "\nAvailable commands: STATUS, ECHO, TIME, PING, GOODBYE";
-        }
-        else if (command == "STATUS") {
-            response = "SERVER STATUS:\n"
-                "  Uptime: " + std::to_string(broadcast_count_) + " seconds\n" +
-                "  Broadcasts: " + std::to_string(broadcast_count_) + "\n" +
-                "  Commands received: " + std::to_string(received_count_) + "\n" +
-                "  Responses sent: " + std::to_string(response_count_) + "\n" +
-                "  Active clients: " + std::to_string(get_client_count());
-        }
-        else if (command.rfind("ECHO ", 0) == 0) {
-            std::string echo_text = command.substr(5);
-            response = "ECHO: " + echo_text;
-        }
-        else if (command == "TIME") {
-            std::ostringstream oss;
-            oss << std::put_time(&time_info, "%Y-%m-%d %H:%M:%S");
-            response = "SERVER TIME: ";
-            response += oss.str();
-        }
-        else if (command == "PING") {
-            response = "PONG from UDP Radio Server";
-        }
-        else if (command == "GOODBYE") {
-            response = "GOODBYE! Thanks for using UDP Radio";
-            //  
-            std::lock_guard<std::mutex> lock(clients_mutex_);
-            clients_.erase(packet.sender_ip);
+    // NACK <first> <last>:    
+    //   .     MAX_NACK_RANGE,   .
+    void UdpRadioServer::handle_nack(net_utils::socket_t sock, const net_utils::UdpBuffer& packet) {
+        char text[64];
+        size_t length = std::min(packet.size, sizeof(text) - 1);
+        memcpy(text, packet.data, length);
+        text[length] = '\0';
+
+        unsigned long first = 0, last = 0;
+        if (sscanf(text, "NACK %lu %lu", &first, &last) != 2 || last < first) return;
+        last = std::min<unsigned long>(last, first + MAX_NACK_RANGE - 1);
+
+        sockaddr_in target = packet.sender;
+        target.sin_port = htons(BROADCAST_PORT);
+        char data[RADIO_SLOT_SIZE];
+        uint64_t now_ms = TimerWheel::now_ms();
+        int resent = 0;
+
+        for (unsigned long seq = first; seq <= last; ++seq) {
+            size_t size = 0;
+            switch (history_.take((uint32_t)seq, data, size, now_ms)) {
+            case RetransmitRing::COPIED:
+                net_utils::write_radio_header(data, (uint32_t)seq, net_utils::RADIO_RETRANSMIT);
+                syscalls_->add();
+                if (net_utils::send_udp_to(sock, data, size, target)) {
+                    ++retransmitted_;
+                    retransmit_bytes_ += size;
+                    ++resent;
+                }
+                break;
+            case RetransmitRing::LIMITED:
+                ++retransmit_limited_;
+                break;
+            case RetransmitRing::MISSING:
+                ++retransmit_missing_;
+                break;
+            }
+        }
+
+        char address[net_utils::ADDRESS_STRLEN];
+        LOG_DEBUG("NACK %lu-%lu from %s: resent %d", first, last,
+            net_utils::format_address(packet.sender, address, sizeof(address)), resent);
+    }
+
+    //   
+    //    response;  ,   
+    int UdpRadioServer::process_command(const net_utils::UdpBuffer& packet, std::string& response) {
+        uint64_t started = Histogram::now_ns();
+        uint8_t type = 0;
+        int response_port;
+
+        //      -   
+        if (packet.size >= radio_frame::HEADER_SIZE &&
+            radio_frame::get_u16(packet.data) == radio_frame::MAGIC) {
+            response_port = process_frame(packet, response, type);
         }
         else {
-            response = "UNKNOWN COMMAND: " + command +
-                "\nAvailable: HELLO, STATUS, ECHO, TIME, PING, GOODBYE";
+            response_port = process_text(packet, response, type);
         }
 
-        //     
-        if (net_utils::send_udp_string(server_socket_, response, packet.sender_ip.c_str(), response_port)) {
-            response_count_++;
-            std::cout << "Response sent to " << packet.sender_ip
-                << ":" << response_port << std::endl;
+        size_t slot = type >= radio_frame::HELLO && type <= radio_frame::GOODBYE ?
+            type - radio_frame::HELLO : LATENCY_SLOTS - 1;
+        command_latency_[slot]->record(Histogram::now_ns() - started);
+        return response_port;
+    }
+
+    //   "COMMAND [] []"; type -       
+    int UdpRadioServer::process_text(const net_utils::UdpBuffer& packet, std::string& response,
+        uint8_t& type) {
+        const char* command = packet.data;
+        size_t length = packet.size;
+        int response_port = ntohs(packet.sender.sin_port); //    
+
+        //      (: "COMMAND <port>")
+        const char* last_space = nullptr;
+        for (size_t i = length; i > 0; --i) {
+            if (command[i - 1] == ' ') {
+                last_space = command + i - 1;
+                break;
+            }
+        }
+        if (last_space && parse_port(last_space + 1, command + length - last_space - 1, response_port)) {
+            length = last_space - command;
+        }
+
+        //    
+        touch_client(packet.sender, command, length, response_port);
+
+        //   ,  :    ,  
+        static constexpr auto text_commands = make_command_table<TextCommand>({
+            { "HELLO", { &UdpRadioServer::command_hello, radio_frame::HELLO } },
+            { "STATUS", { &UdpRadioServer::command_status, radio_frame::STATUS } },
+            { "ECHO", { &UdpRadioServer::command_echo, radio_frame::ECHO } },
+            { "TIME", { &UdpRadioServer::command_time, radio_frame::TIME } },
+            { "PING", { &UdpRadioServer::command_ping, radio_frame::PING } },
+            { "GOODBYE", { &UdpRadioServer::command_goodbye, radio_frame::GOODBYE } }
+        });
+
+        ParsedCommand parsed = parse_command(std::string_view(command, length));
+        TextRequest request{ parsed.args, response_port, packet.sender, response };
+        if (const TextCommand* handler = text_commands.find(parsed.name)) {
+            type = handler->type;
+            (this->*handler->handler)(request);
         }
         else {
-            std::cerr << "Failed to send response to " << packet.sender_ip
-                << ":" << response_port << std::endl;
+            response.append("UNKNOWN COMMAND: ");
+            response.append(command, length);
+            response.append("\nAvailable: HELLO, STATUS, ECHO, TIME, PING, GOODBYE");
         }
+        return response_port;
     }
 
-    void UdpRadioServer::cleanup_inactive_clients() {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
+    void UdpRadioServer::command_hello(TextRequest& request) {
+        char text[256];
+        int text_length = snprintf(text, sizeof(text),
+            "WELCOME to UDP Radio Server! Your response port: %d"
+            "\nAvailable commands: STATUS, ECHO, TIME, PING, GOODBYE", request.response_port);
+        request.response.append(text, std::min<size_t>(std::max(text_length, 0), sizeof(text) - 1));
+    }
 
-        auto now = std::chrono::system_clock::now();
-        auto threshold = now - std::chrono::seconds(60); // 60  
+    void UdpRadioServer::command_status(TextRequest& request) {
+        //     
+        char text[512];
+        RateTicker::Stats jitter = get_jitter();
+        int text_length = snprintf(text, sizeof(text),
+            "SERVER STATUS:\n"
+            "  Uptime: %lld seconds\n"
+            "  Broadcasts: %lld\n"
+            "  Broadcast jitter: mean %.1f us, max %.1f us, missed %llu\n"
+            "  Retransmits: %lld (limited %lld, expired %lld), overhead %.2f%%\n"
+            "  Commands received: %lld\n"
+            "  Responses sent: %lld\n"
+            "  Active clients: %zu",
+            (long long)std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::steady_clock::now() - start_time_).count(),
+            broadcast_count_.load(), jitter.mean_us, jitter.max_us,
+            (unsigned long long)jitter.missed, retransmitted_.load(),
+            retransmit_limited_.load(), retransmit_missing_.load(),
+            get_retransmit_overhead(), get_received_count(),
+            get_response_count(), get_client_count());
+        request.response.append(text, std::min<size_t>(std::max(text_length, 0), sizeof(text) - 1));
+    }
+
+    void UdpRadioServer::command_echo(TextRequest& request) {
+        request.response.append("ECHO: ");
+        request.response.append(request.args.data(), request.args.size());
+    }
 
-        for (auto it = clients_.begin(); it != clients_.end(); ) {
-            if (it->second.last_active < threshold) {
-                std::cout << "Removing inactive client: " << it->first << std::endl;
-                it = clients_.erase(it);
+    void UdpRadioServer::command_time(TextRequest& request) {
+        char text[64];
+        auto time = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        struct tm time_info;
+        localtime_s(&time_info, &time);
+        request.response.append("SERVER TIME: ");
+        request.response.append(text, strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &time_info));
+    }
+
+    void UdpRadioServer::command_ping(TextRequest& request) {
+        request.response.append("PONG from UDP Radio Server");
+    }
+
+    void UdpRadioServer::command_goodbye(TextRequest& request) {
+        request.response.append("GOODBYE! Thanks for using UDP Radio");
+        forget_client(request.sender);
+    }
+
+    //  :   ,  -    .
+    //     ,     .
+    int UdpRadioServer::process_frame(const net_utils::UdpBuffer& packet, std::string& response,
+        uint8_t& type) {
+        int response_port = ntohs(packet.sender.sin_port);
+        response.resize(radio_frame::MAX_FRAME);    //   reserve -  
+        char* out = &response[0];
+        size_t size = 0;
+
+        radio_frame::Header header;
+        const char* payload = nullptr;
+        radio_frame::Command command;
+        radio_frame::DecodeStatus status = radio_frame::decode(packet.data, packet.size, header, payload);
+        bool with_checksum = status == radio_frame::DecodeStatus::Ok &&
+            (header.flags & radio_frame::FLAG_CHECKSUM);
+
+        if (status != radio_frame::DecodeStatus::Ok || !radio_frame::decode_command(header, payload, command)) {
+            const char* error = status == radio_frame::DecodeStatus::Ok ?
+                "bad command" : radio_frame::status_name(status);
+            size = radio_frame::encode_bytes(out, radio_frame::ERROR_REPLY, error, strlen(error), false);
+            response.resize(size);
+            return response_port;
+        }
+
+        if (command.response_port) response_port = command.response_port;
+        type = command.type;
+        const char* name = radio_frame::type_name(command.type);
+        touch_client(packet.sender, name, strlen(name), response_port);
+
+        switch (command.type) {
+        case radio_frame::HELLO: {
+            radio_frame::Welcome welcome;
+            welcome.version = radio_frame::VERSION;
+            welcome.binary_radio = config_.binary_radio;
+            welcome.response_port = (uint16_t)response_port;
+            size = radio_frame::encode_welcome(out, welcome, with_checksum);
+            break;
+        }
+        case radio_frame::STATUS: {
+            radio_frame::Status server_status;
+            server_status.uptime_s = std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::steady_clock::now() - start_time_).count();
+            server_status.broadcasts = broadcast_count_.load();
+            server_status.retransmits = retransmitted_.load();
+            server_status.received = get_received_count();
+            server_status.responses = get_response_count();
+            server_status.clients = (uint32_t)get_client_count();
+            size = radio_frame::encode_status(out, server_status, with_checksum);
+            break;
+        }
+        case radio_frame::ECHO:
+            size = radio_frame::encode_bytes(out, radio_frame::ECHO_REPLY,
+                command.text, command.text_size, with_checksum);
+            break;
+        case radio_frame::TIME:
+            size = radio_frame::encode_time(out, std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count(), with_checksum);
+            break;
+        case radio_frame::PING:
+            size = radio_frame::encode_bytes(out, radio_frame::PONG, nullptr, 0, with_checksum);
+            break;
+        case radio_frame::GOODBYE:
+            size = radio_frame::encode_bytes(out, radio_frame::BYE, nullptr, 0, with_checksum);
+            forget_client(packet.sender);
+            break;
+        }
+
+        response.resize(size);
+        return response_port;
+    }
+
+    //   :  (   )
+    void UdpRadioServer::touch_client(const sockaddr_in& sender, const char* command, size_t length,
+        int response_port) {
+        uint64_t client_key = UdpClientTable::make_key(sender);
+        ClientTable& table = table_for(client_key);
+        uint64_t now_ms = TimerWheel::now_ms();
+        {
+            std::lock_guard<std::mutex> lock(table.mutex);
+            bool inserted;
+            UdpClientTable::Client& client = table.clients.upsert(client_key, inserted);
+            if (inserted) {
+                ++client_count_;
+                registered_.add();
+                client.timer = table.timers.arm(client_key, config_.client_timeout_ms, now_ms);
             }
             else {
-                ++it;
+                //  -   , O(1)
+                table.timers.rearm(client.timer, config_.client_timeout_ms, now_ms);
             }
+
+            client.response_port = (uint16_t)response_port;
+            size_t stored = std::min(length, UdpClientTable::COMMAND_SIZE);
+            memcpy(client.last_command, command, stored);
+            memset(client.last_command + stored, 0, UdpClientTable::COMMAND_SIZE - stored);
+        }
+
+        //   ,   
+        char address[net_utils::ADDRESS_STRLEN];
+        LOG_DEBUG("%s -> %.*s (response port: %d)",
+            net_utils::format_address(sender, address, sizeof(address)),
+            (int)length, command, response_port);
+    }
+
+    void UdpRadioServer::forget_client(const sockaddr_in& sender) {
+        uint64_t client_key = UdpClientTable::make_key(sender);
+        ClientTable& table = table_for(client_key);
+        std::lock_guard<std::mutex> lock(table.mutex);
+        UdpClientTable::Client* client = table.clients.find(client_key);
+        if (client) {
+            table.timers.cancel(client->timer);
+            table.clients.erase(client_key);
+            --client_count_;
+        }
+    }
+
+    //       (     )
+    UdpRadioServer::ClientTable& UdpRadioServer::table_for(uint64_t client_key) {
+        return clients_[UdpClientTable::hash(client_key) % CLIENT_PARTS];
+    }
+
+    //     ,  
+    double UdpRadioServer::get_retransmit_overhead() {
+        long long sent = broadcast_bytes_.load();
+        return sent ? 100.0 * retransmit_bytes_.load() / sent : 0.0;
+    }
+
+    RateTicker::Stats UdpRadioServer::get_jitter() {
+        std::lock_guard<std::mutex> lock(jitter_mutex_);
+        return jitter_;
+    }
+
+    void UdpRadioServer::expire_idle_clients() {
+        uint64_t now_ms = TimerWheel::now_ms();
+
+        //     ,    -   
+        for (ClientTable& table : clients_) {
+            std::lock_guard<std::mutex> lock(table.mutex);
+            table.timers.advance(now_ms, [&](uint64_t client_key) {
+                if (!table.clients.erase(client_key)) return;
+                --client_count_;
+
+                char address[net_utils::ADDRESS_STRLEN];
+                sockaddr_in sender = UdpClientTable::address_of(client_key);
+                LOG_INFO("Removing inactive client: %s",
+                    net_utils::format_address(sender, address, sizeof(address)));
+            });
         }
     }
 
     size_t UdpRadioServer::get_client_count() {
-        std::lock_guard<std::mutex> lock(clients_mutex_);
-        return clients_.size();
+        return client_count_;
+    }
+
+    long long UdpRadioServer::get_received_count() {
+        return (long long)received_.value();
+    }
+
+    long long UdpRadioServer::get_response_count() {
+        return (long long)responses_.value();
     }
\ No newline at end of file
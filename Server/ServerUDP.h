@@ -1,48 +1,162 @@
 #pragma once
 #include "../Common/net_utils.h"
+#include "../Common/radio_frame.h"
+#include "UdpClientTable.h"
+#include "TimerWheel.h"
+#include "RateTicker.h"
+#include "RetransmitRing.h"
+#include "Metrics.h"
+#include "Uring.h"
 #include <iostream>
 #include <thread>
 #include <atomic>
 #include <vector>
-#include <map>
 #include <mutex>
 #include <chrono>
 #include <random>
+#include <string_view>
+#include <memory>
+
+struct UdpServerConfig {
+    size_t batch_size = 1;      //    recvmmsg/sendmmsg (1 -  )
+    size_t workers = 1;         //   ,     (SO_REUSEPORT)
+    uint64_t client_timeout_ms = 60000;     //    
+    std::string multicast_group;    //  -  broadcast,    (239.x.x.x)
+    int multicast_ttl = 1;          // 1 -    
+    bool multicast_loopback = true; //      
+    double tick_rate = 1.0;         //    ( )
+    size_t retransmit_window = 1024;    //     
+    double retransmit_rate = 500;       //   NACK  ,  
+    bool binary_radio = false;      //      
+    bool radio_checksum = false;    //     
+    bool uring = false;             //     io_uring (Linux 5.19+,    )
+};
 
 class UdpRadioServer {
 private:
-    net_utils::socket_t server_socket_;
+    friend class UdpServerProbe;    //  (Bench/MicroBench.cpp)
+
+    static const size_t MAX_WORKERS = 64;
+    static const size_t RADIO_SLOT_SIZE = 512;  //   
+    static const uint32_t MAX_NACK_RANGE = 64;  //    NACK
+
+    UdpServerConfig config_;
+    //   RESPONSE_PORT,     .
+    //     .  SO_REUSEPORT    .
+    std::vector<net_utils::socket_t> sockets_;
     std::atomic<bool> running_{ true };
     std::thread broadcast_thread_;
-    std::thread receive_thread_;
+    std::vector<std::thread> receive_threads_;
+    net_utils::UdpBufferPool buffers_;   //   (   )
 
-    struct ClientInfo {
-        std::string last_command;
-        int response_port;
-        std::chrono::system_clock::time_point last_active;
+    // ,    -.
+    //      (IP, ):     .
+    //        -    .
+    static const size_t CLIENT_PARTS = 64;
+
+    struct alignas(64) ClientTable {
+        UdpClientTable clients;
+        TimerWheel timers;
+        std::mutex mutex;
     };
 
-    // ,    -
-    std::map<std::string, ClientInfo> clients_;
-    std::mutex clients_mutex_;
+    ClientTable clients_[CLIENT_PARTS];
+    std::atomic<size_t> client_count_{ 0 };
+
+    //    :    ,     .
+    //   -   ,   -   .
+    static const size_t LATENCY_SLOTS = radio_frame::GOODBYE - radio_frame::HELLO + 2;
+
+    Counter& received_;
+    Counter& responses_;
+    Counter& received_bytes_;
+    Counter& response_bytes_;
+    Counter& registered_;           //  
+    Histogram& receive_batch_;      //    recvmmsg
+    Counter* syscalls_;             //      ( -  )
+    Histogram* command_latency_[LATENCY_SLOTS];
+    std::atomic<long long> broadcast_count_{ 0 };
+    std::chrono::steady_clock::time_point start_time_;
+    sockaddr_in broadcast_target_;      //   255.255.255.255
+
+    //    NACK    (   )
+    RetransmitRing history_;
+    std::atomic<long long> broadcast_bytes_{ 0 };
+    std::atomic<long long> retransmitted_{ 0 };
+    std::atomic<long long> retransmit_bytes_{ 0 };
+    std::atomic<long long> retransmit_limited_{ 0 };
+    std::atomic<long long> retransmit_missing_{ 0 };
 
-    // 
-    std::atomic<int> broadcast_count_{ 0 };
-    std::atomic<int> received_count_{ 0 };
-    std::atomic<int> response_count_{ 0 };
+    //      ( STATUS)
+    std::mutex jitter_mutex_;
+    RateTicker::Stats jitter_;
+
+    #ifdef NET_URING
+    //  : multishot recvmsg   ,  -  sendmsg
+    static const unsigned URING_ENTRIES = 512;
+    static const unsigned URING_BUFFERS = 256;      //  
+    static const size_t URING_BUFFER_SIZE = 8192;   //  ;  - 
+    static const size_t URING_SLOTS = 256;          //     
+
+    struct UringWorker {
+        IoUring ring;
+        ProvidedBuffers buffers;
+        UringWorker(Counter* syscalls)
+            : ring(URING_ENTRIES, syscalls),
+            buffers(ring, 0, URING_BUFFERS, URING_BUFFER_SIZE) {}
+    };
+    std::vector<std::unique_ptr<UringWorker>> uring_workers_;
+    #endif
 
     const int BROADCAST_PORT = 12345;
     const int RESPONSE_PORT = 12346;
 public:
-    UdpRadioServer();
+    explicit UdpRadioServer(const UdpServerConfig& config = UdpServerConfig());
     ~UdpRadioServer();
     void start();
     void stop();
 private:
-    std::string generate_broadcast_data();
+    size_t build_broadcast(uint32_t seq, char* out);
     void broadcast_loop();
-    void receive_loop();
-    void process_command(const net_utils::UdpPacket& packet);
-    void cleanup_inactive_clients();
+    void receive_loop(size_t worker);
+    void receive_batched(size_t worker);
+    #ifdef NET_URING
+    void receive_uring(size_t worker);
+    #endif
+    //    :     
+    struct TextRequest {
+        std::string_view args;
+        int response_port;
+        const sockaddr_in& sender;
+        std::string& response;
+    };
+
+    using TextHandler = void (UdpRadioServer::*)(TextRequest& request);
+
+    //          (  )
+    struct TextCommand {
+        TextHandler handler;
+        uint8_t type;
+    };
+
+    void command_hello(TextRequest& request);
+    void command_status(TextRequest& request);
+    void command_echo(TextRequest& request);
+    void command_time(TextRequest& request);
+    void command_ping(TextRequest& request);
+    void command_goodbye(TextRequest& request);
+    void handle_nack(net_utils::socket_t sock, const net_utils::UdpBuffer& packet);
+    int process_command(const net_utils::UdpBuffer& packet, std::string& response);
+    int process_text(const net_utils::UdpBuffer& packet, std::string& response, uint8_t& type);
+    int process_frame(const net_utils::UdpBuffer& packet, std::string& response, uint8_t& type);
+    void register_metrics();
+    void touch_client(const sockaddr_in& sender, const char* command, size_t length, int response_port);
+    void forget_client(const sockaddr_in& sender);
+    ClientTable& table_for(uint64_t client_key);
+    void expire_idle_clients();
+    RateTicker::Stats get_jitter();
+    double get_retransmit_overhead();
     size_t get_client_count();
+    long long get_received_count();
+    long long get_response_count();
 };
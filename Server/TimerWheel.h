@@ -0,0 +1,215 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <chrono>
+#include <algorithm>
+
+//   : 4   64 .  0 -  
+//  ,    64  ;    
+//    . ,    - O(1): 
+//          .
+//   O( + ),   O( ).
+//  - .
+class TimerWheel {
+public:
+    //     :      
+    using Handle = uint64_t;
+    static const Handle NONE = 0;
+
+    static uint64_t now_ms() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+private:
+    static const unsigned LEVEL_BITS = 6;
+    static const unsigned SLOTS = 1u << LEVEL_BITS;
+    static const unsigned LEVELS = 4;
+    static const uint64_t MAX_SPAN = 1ull << (LEVEL_BITS * LEVELS);    //  
+    static const uint32_t NIL = 0xffffffff;
+    static const uint16_t DETACHED = 0xffff;
+
+    struct Node {
+        uint64_t key;               //    
+        uint64_t expires;           //  
+        uint32_t prev;
+        uint32_t next;
+        uint32_t generation;
+        uint16_t slot;              //  * SLOTS + , DETACHED -   
+    };
+
+    uint64_t tick_ms_;
+    uint64_t now_tick_;
+    std::vector<Node> nodes_;
+    uint32_t free_head_ = NIL;
+    uint32_t heads_[LEVELS * SLOTS];
+    size_t size_ = 0;
+    std::vector<uint64_t> expired_;     // ,    
+
+    static Handle make_handle(uint32_t index, uint32_t generation) {
+        return ((uint64_t)generation << 32) | index;
+    }
+
+    Node* resolve(Handle handle) {
+        uint32_t index = (uint32_t)handle;
+        if (handle == NONE || index >= nodes_.size()) return nullptr;
+        Node& node = nodes_[index];
+        if (node.generation != (uint32_t)(handle >> 32) || node.slot == DETACHED) return nullptr;
+        return &node;
+    }
+
+    void link(uint32_t index) {
+        Node& node = nodes_[index];
+        uint64_t delta = node.expires > now_tick_ ? node.expires - now_tick_ : 0;
+        //   -    ,    
+        uint64_t target = delta < MAX_SPAN ? node.expires : now_tick_ + MAX_SPAN - 1;
+        if (delta >= MAX_SPAN) delta = MAX_SPAN - 1;
+
+        unsigned level = 0;
+        while (level + 1 < LEVELS && delta >= (1ull << (LEVEL_BITS * (level + 1)))) ++level;
+        unsigned slot = level * SLOTS + (unsigned)((target >> (LEVEL_BITS * level)) & (SLOTS - 1));
+
+        node.slot = (uint16_t)slot;
+        node.prev = NIL;
+        node.next = heads_[slot];
+        if (node.next != NIL) nodes_[node.next].prev = index;
+        heads_[slot] = index;
+    }
+
+    void unlink(uint32_t index) {
+        Node& node = nodes_[index];
+        if (node.prev != NIL) nodes_[node.prev].next = node.next;
+        else heads_[node.slot] = node.next;
+        if (node.next != NIL) nodes_[node.next].prev = node.prev;
+        node.slot = DETACHED;
+    }
+
+    void release(uint32_t index) {
+        Node& node = nodes_[index];
+        node.slot = DETACHED;
+        ++node.generation;
+        if (node.generation == 0) node.generation = 1;
+        node.next = free_head_;
+        free_head_ = index;
+        --size_;
+    }
+
+    uint64_t to_tick(uint64_t ms) const {
+        return ms / tick_ms_;
+    }
+
+    //    level   .   .
+    unsigned cascade(unsigned level) {
+        unsigned index = (unsigned)((now_tick_ >> (LEVEL_BITS * level)) & (SLOTS - 1));
+        uint32_t node = heads_[level * SLOTS + index];
+        heads_[level * SLOTS + index] = NIL;
+        while (node != NIL) {
+            uint32_t next = nodes_[node].next;
+            link(node);
+            node = next;
+        }
+        return index;
+    }
+
+    //  :        0
+    void step() {
+        ++now_tick_;
+        unsigned index = (unsigned)(now_tick_ & (SLOTS - 1));
+        for (unsigned level = 1; level < LEVELS && index == 0; ++level) {
+            index = cascade(level) == 0 ? 0 : 1;
+        }
+
+        unsigned slot = (unsigned)(now_tick_ & (SLOTS - 1));
+        uint32_t node = heads_[slot];
+        heads_[slot] = NIL;
+        while (node != NIL) {
+            uint32_t next = nodes_[node].next;
+            if (nodes_[node].expires > now_tick_) {
+                link(node);     //    -   
+            }
+            else {
+                expired_.push_back(nodes_[node].key);
+                release(node);
+            }
+            node = next;
+        }
+    }
+public:
+    explicit TimerWheel(uint64_t tick_ms = 100)
+        : tick_ms_(tick_ms ? tick_ms : 1), now_tick_(now_ms() / (tick_ms ? tick_ms : 1)) {
+        for (auto& head : heads_) head = NIL;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    uint64_t tick_ms() const {
+        return tick_ms_;
+    }
+
+    //    now_ms + delay_ms (   )
+    Handle arm(uint64_t key, uint64_t delay_ms, uint64_t now_ms) {
+        uint32_t index;
+        if (free_head_ != NIL) {
+            index = free_head_;
+            free_head_ = nodes_[index].next;
+        }
+        else {
+            index = (uint32_t)nodes_.size();
+            nodes_.push_back(Node{ 0, 0, NIL, NIL, 1, DETACHED });
+        }
+
+        Node& node = nodes_[index];
+        node.key = key;
+        node.expires = std::max(to_tick(now_ms + delay_ms + tick_ms_ - 1), now_tick_ + 1);
+        link(index);
+        ++size_;
+        return make_handle(index, node.generation);
+    }
+
+    // false -     
+    bool rearm(Handle handle, uint64_t delay_ms, uint64_t now_ms) {
+        Node* node = resolve(handle);
+        if (!node) return false;
+
+        uint32_t index = (uint32_t)handle;
+        uint64_t expires = std::max(to_tick(now_ms + delay_ms + tick_ms_ - 1), now_tick_ + 1);
+        if (expires == node->expires) return true;   //    -  
+
+        unlink(index);
+        nodes_[index].expires = expires;
+        link(index);
+        return true;
+    }
+
+    bool cancel(Handle handle) {
+        Node* node = resolve(handle);
+        if (!node) return false;
+
+        uint32_t index = (uint32_t)handle;
+        unlink(index);
+        release(index);
+        return true;
+    }
+
+    //    now_ms   on_expire(key)  .
+    //      .  .
+    template <typename OnExpire>
+    size_t advance(uint64_t now_ms, OnExpire on_expire) {
+        uint64_t target = to_tick(now_ms);
+        if (size_ == 0 && target > now_tick_) {
+            now_tick_ = target;     //   -   
+        }
+        while (now_tick_ < target) {
+            step();
+        }
+
+        //  -  ,     
+        size_t fired = expired_.size();
+        for (size_t i = 0; i < fired; ++i) {
+            on_expire(expired_[i]);
+        }
+        expired_.clear();
+        return fired;
+    }
+};
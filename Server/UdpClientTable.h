@@ -0,0 +1,145 @@
+#pragma once
+#include "../Common/net_utils.h"
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+//  UDP-:     .
+//  -   (IPv4,  ),    
+// NAT    .      (32 ,
+//    ),      -   .
+//  -  ,  .  - .
+class UdpClientTable {
+public:
+    static const size_t COMMAND_SIZE = 14;
+
+    struct Client {
+        uint64_t key;                       // 0 -  
+        uint64_t timer;                     //   (TimerWheel::Handle)
+        uint16_t response_port;             //   ( )
+        char last_command[COMMAND_SIZE];    //    ( ,  )
+    };
+
+    //      -   
+    static uint64_t make_key(const sockaddr_in& address) {
+        return ((uint64_t)ntohl(address.sin_addr.s_addr) << 16) | ntohs(address.sin_port);
+    }
+
+    static sockaddr_in address_of(uint64_t key) {
+        sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl((uint32_t)(key >> 16));
+        address.sin_port = htons((uint16_t)key);
+        return address;
+    }
+
+    //  splitmix64:     ,
+    //       ,  - 
+    static uint64_t hash(uint64_t key) {
+        key ^= key >> 30;
+        key *= 0xbf58476d1ce4e5b9ULL;
+        key ^= key >> 27;
+        key *= 0x94d049bb133111ebULL;
+        key ^= key >> 31;
+        return key;
+    }
+private:
+    std::vector<Client> slots_;
+    size_t size_ = 0;
+    unsigned shift_;                        // 64 - log2()
+
+    size_t index_of(uint64_t key) const {
+        return (size_t)(hash(key) >> shift_);
+    }
+
+    size_t next(size_t index) const {
+        return (index + 1) & (slots_.size() - 1);
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<Client> old(capacity);
+        old.swap(slots_);
+        shift_ = 64;
+        for (size_t c = capacity; c > 1; c >>= 1) --shift_;
+
+        for (const Client& client : old) {
+            if (client.key == 0) continue;
+            size_t index = index_of(client.key);
+            while (slots_[index].key != 0) index = next(index);
+            slots_[index] = client;
+        }
+    }
+public:
+    explicit UdpClientTable(size_t capacity = 64) {
+        size_t rounded = 16;
+        while (rounded < capacity) rounded <<= 1;
+        slots_.resize(rounded);
+        shift_ = 64;
+        for (size_t c = rounded; c > 1; c >>= 1) --shift_;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    Client* find(uint64_t key) {
+        for (size_t index = index_of(key); slots_[index].key != 0; index = next(index)) {
+            if (slots_[index].key == key) return &slots_[index];
+        }
+        return nullptr;
+    }
+
+    //   .     .
+    Client& upsert(uint64_t key, bool& inserted) {
+        //    3/4,    
+        if ((size_ + 1) * 4 > slots_.size() * 3) {
+            rehash(slots_.size() * 2);
+        }
+
+        size_t index = index_of(key);
+        while (slots_[index].key != 0) {
+            if (slots_[index].key == key) {
+                inserted = false;
+                return slots_[index];
+            }
+            index = next(index);
+        }
+
+        Client& client = slots_[index];
+        memset(&client, 0, sizeof(client));
+        client.key = key;
+        ++size_;
+        inserted = true;
+        return client;
+    }
+
+    bool erase(uint64_t key) {
+        size_t index = index_of(key);
+        while (slots_[index].key != key) {
+            if (slots_[index].key == 0) return false;
+            index = next(index);
+        }
+        erase_at(index);
+        return true;
+    }
+
+private:
+    //  :   ,      
+    void erase_at(size_t hole) {
+        size_t index = next(hole);
+        while (slots_[index].key != 0) {
+            size_t home = index_of(slots_[index].key);
+            //     ,         
+            bool movable = hole <= index ? (home <= hole || home > index)
+                : (home <= hole && home > index);
+            if (movable) {
+                slots_[hole] = slots_[index];
+                hole = index;
+            }
+            index = next(index);
+        }
+        slots_[hole].key = 0;
+        --size_;
+    }
+};
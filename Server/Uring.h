@@ -0,0 +1,258 @@
+#pragma once
+#include "../Common/net_utils.h"
+
+// io_uring  liburing:       .
+//   (Windows,  ) - NET_URING  
+//     epoll/recvmmsg.
+#if defined(NET_LINUX) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define NET_URING
+#endif
+#endif
+
+#ifdef NET_URING
+#include "Metrics.h"
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <ctime>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//  /  .    
+//      io_uring_enter    .
+class IoUring {
+public:
+    struct Stats {
+        uint64_t enters = 0;        //   io_uring_enter
+        uint64_t submitted = 0;     //  (SQE)  
+        uint64_t completed = 0;     //  (CQE) 
+    };
+private:
+    int fd_ = -1;
+    io_uring_params params_ = {};
+    void* sq_ring_ = MAP_FAILED;
+    void* cq_ring_ = MAP_FAILED;
+    size_t sq_ring_size_ = 0;
+    size_t cq_ring_size_ = 0;
+    io_uring_sqe* sqes_ = (io_uring_sqe*)MAP_FAILED;
+
+    std::atomic<unsigned>* sq_head_;
+    std::atomic<unsigned>* sq_tail_;
+    unsigned sq_mask_;
+    std::atomic<unsigned>* cq_head_;
+    std::atomic<unsigned>* cq_tail_;
+    unsigned cq_mask_;
+    io_uring_cqe* cqes_;
+
+    unsigned sqe_tail_ = 0;         // ,      -  
+    Stats stats_;
+    Counter* syscalls_;             //     (  nullptr)
+
+    void release() {
+        if (sqes_ != MAP_FAILED) munmap(sqes_, params_.sq_entries * sizeof(io_uring_sqe));
+        if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) munmap(cq_ring_, cq_ring_size_);
+        if (sq_ring_ != MAP_FAILED) munmap(sq_ring_, sq_ring_size_);
+        if (fd_ >= 0) close(fd_);
+    }
+
+    template <typename T>
+    static T* at(void* base, uint32_t offset) {
+        return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+    }
+public:
+    // entries -   ;    (multishot   CQE  )
+    explicit IoUring(unsigned entries, Counter* syscalls = nullptr) : syscalls_(syscalls) {
+        params_.flags = IORING_SETUP_CQSIZE | IORING_SETUP_COOP_TASKRUN;
+        params_.cq_entries = entries * 4;
+        fd_ = (int)syscall(__NR_io_uring_setup, entries, &params_);
+        if (fd_ < 0 && errno == EINVAL) {
+            //   5.19   COOP_TASKRUN
+            params_ = {};
+            params_.flags = IORING_SETUP_CQSIZE;
+            params_.cq_entries = entries * 4;
+            fd_ = (int)syscall(__NR_io_uring_setup, entries, &params_);
+        }
+        if (fd_ < 0) {
+            throw std::runtime_error("io_uring_setup failed: " + std::to_string(errno));
+        }
+        if (!(params_.features & IORING_FEAT_EXT_ARG)) {
+            release();
+            throw std::runtime_error("io_uring without wait timeouts (kernel 5.11+ needed)");
+        }
+
+        sq_ring_size_ = params_.sq_off.array + params_.sq_entries * sizeof(unsigned);
+        cq_ring_size_ = params_.cq_off.cqes + params_.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = (params_.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+
+        sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+            fd_, IORING_OFF_SQ_RING);
+        cq_ring_ = single_mmap || sq_ring_ == MAP_FAILED ? sq_ring_ :
+            mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                fd_, IORING_OFF_CQ_RING);
+        sqes_ = (io_uring_sqe*)mmap(nullptr, params_.sq_entries * sizeof(io_uring_sqe),
+            PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+        if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+            release();
+            throw std::runtime_error("io_uring mmap failed");
+        }
+
+        sq_head_ = at<std::atomic<unsigned>>(sq_ring_, params_.sq_off.head);
+        sq_tail_ = at<std::atomic<unsigned>>(sq_ring_, params_.sq_off.tail);
+        sq_mask_ = *at<unsigned>(sq_ring_, params_.sq_off.ring_mask);
+        cq_head_ = at<std::atomic<unsigned>>(cq_ring_, params_.cq_off.head);
+        cq_tail_ = at<std::atomic<unsigned>>(cq_ring_, params_.cq_off.tail);
+        cq_mask_ = *at<unsigned>(cq_ring_, params_.cq_off.ring_mask);
+        cqes_ = at<io_uring_cqe>(cq_ring_, params_.cq_off.cqes);
+
+        //       :  i -  i
+        unsigned* array = at<unsigned>(sq_ring_, params_.sq_off.array);
+        for (unsigned i = 0; i < params_.sq_entries; ++i) array[i] = i;
+        sqe_tail_ = sq_tail_->load(std::memory_order_relaxed);
+    }
+
+    ~IoUring() {
+        release();
+    }
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    int fd() const { return fd_; }
+    const Stats& stats() const { return stats_; }
+
+    //  .   -    .
+    io_uring_sqe* sqe() {
+        if (sqe_tail_ - sq_head_->load(std::memory_order_acquire) >= params_.sq_entries) {
+            submit();
+        }
+        io_uring_sqe* entry = &sqes_[sqe_tail_ & sq_mask_];
+        memset(entry, 0, sizeof(*entry));
+        ++sqe_tail_;
+        return entry;
+    }
+
+    //    (wait > 0)  ,    timeout_ms (-1 -  ).
+    //     .   (, ) -   .
+    void submit(unsigned wait = 0, int timeout_ms = -1) {
+        unsigned pending = sqe_tail_ - sq_tail_->load(std::memory_order_relaxed);
+        sq_tail_->store(sqe_tail_, std::memory_order_release);
+        if (pending == 0 && wait == 0) return;
+
+        unsigned flags = wait ? IORING_ENTER_GETEVENTS : 0;
+        io_uring_getevents_arg arg = {};
+        timespec timeout;
+        void* arg_ptr = nullptr;
+        size_t arg_size = 0;
+        if (wait && timeout_ms >= 0) {
+            timeout.tv_sec = timeout_ms / 1000;
+            timeout.tv_nsec = (timeout_ms % 1000) * 1000000L;
+            arg.sigmask_sz = _NSIG / 8;
+            arg.ts = (uint64_t)(uintptr_t)&timeout;
+            flags |= IORING_ENTER_EXT_ARG;
+            arg_ptr = &arg;
+            arg_size = sizeof(arg);
+        }
+
+        int result;
+        do {
+            result = (int)syscall(__NR_io_uring_enter, fd_, pending, wait, flags, arg_ptr, arg_size);
+            ++stats_.enters;
+            if (syscalls_) syscalls_->add();
+        } while (result < 0 && errno == EINTR && pending > 0);
+
+        if (result > 0) stats_.submitted += result;
+    }
+
+    //    
+    template <typename Handler>
+    unsigned drain(Handler&& handler) {
+        unsigned head = cq_head_->load(std::memory_order_relaxed);
+        unsigned tail = cq_tail_->load(std::memory_order_acquire);
+        unsigned count = 0;
+        while (head != tail) {
+            // :          
+            io_uring_cqe cqe = cqes_[head & cq_mask_];
+            cq_head_->store(++head, std::memory_order_release);
+            handler(cqe);
+            ++count;
+            tail = cq_tail_->load(std::memory_order_acquire);
+        }
+        stats_.completed += count;
+        return count;
+    }
+};
+
+//  ,         
+// (IORING_REGISTER_PBUF_RING,  5.19+).      .
+class ProvidedBuffers {
+private:
+    IoUring& ring_;
+    uint16_t group_;
+    unsigned count_;
+    size_t size_;
+    io_uring_buf* entries_;         //   -   resv  
+    size_t entries_bytes_;
+    std::vector<char> storage_;
+    uint16_t tail_ = 0;
+
+    std::atomic<uint16_t>& tail() {
+        return *reinterpret_cast<std::atomic<uint16_t>*>(&entries_[0].resv);
+    }
+public:
+    // count -  
+    ProvidedBuffers(IoUring& ring, uint16_t group, unsigned count, size_t size)
+        : ring_(ring), group_(group), count_(count), size_(size), storage_(count * size) {
+        entries_bytes_ = count * sizeof(io_uring_buf);
+        void* memory = mmap(nullptr, entries_bytes_, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) throw std::runtime_error("buffer ring mmap failed");
+        entries_ = (io_uring_buf*)memory;
+
+        io_uring_buf_reg reg = {};
+        reg.ring_addr = (uint64_t)(uintptr_t)entries_;
+        reg.ring_entries = count;
+        reg.bgid = group;
+        if (syscall(__NR_io_uring_register, ring.fd(), IORING_REGISTER_PBUF_RING, &reg, 1) != 0) {
+            munmap(entries_, entries_bytes_);
+            throw std::runtime_error("io_uring buffer ring needs kernel 5.19+");
+        }
+
+        for (unsigned i = 0; i < count; ++i) put((uint16_t)i);
+    }
+
+    ~ProvidedBuffers() {
+        io_uring_buf_reg reg = {};
+        reg.bgid = group_;
+        syscall(__NR_io_uring_register, ring_.fd(), IORING_UNREGISTER_PBUF_RING, &reg, 1);
+        munmap(entries_, entries_bytes_);
+    }
+
+    ProvidedBuffers(const ProvidedBuffers&) = delete;
+    ProvidedBuffers& operator=(const ProvidedBuffers&) = delete;
+
+    uint16_t group() const { return group_; }
+    size_t size() const { return size_; }
+
+    char* data(uint16_t id) { return &storage_[(size_t)id * size_]; }
+
+    //    
+    static uint16_t id_of(const io_uring_cqe& cqe) {
+        return (uint16_t)(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+    }
+
+    //   
+    void put(uint16_t id) {
+        io_uring_buf& entry = entries_[tail_ & (count_ - 1)];
+        entry.addr = (uint64_t)(uintptr_t)data(id);
+        entry.len = (uint32_t)size_;
+        entry.bid = id;
+        tail().store(++tail_, std::memory_order_release);
+    }
+};
+#endif
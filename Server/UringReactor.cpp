@@ -0,0 +1,543 @@
+#include "UringReactor.h"
+
+#ifdef NET_URING
+#include "Server.h"
+#include "Logger.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <sys/eventfd.h>
+
+// ,      
+static thread_local UringReactor* current_reactor = nullptr;
+
+UringReactor::UringReactor(net_utils::socket_t listen_socket, int shard_index,
+    size_t max_frame_size, uint64_t idle_timeout_ms)
+    : listen_socket_(listen_socket), shard_index_(shard_index), max_frame_size_(max_frame_size),
+    idle_timeout_ms_(idle_timeout_ms),
+    syscalls_(MetricsRegistry::instance().counter("chat_io_syscalls_total",
+        "Socket and event-loop system calls made by reactors", "backend=\"uring\"")),
+    ring_(RING_ENTRIES, &syscalls_), buffers_(ring_, BUFFER_GROUP, BUFFER_COUNT, BUFFER_SIZE) {
+    wakeup_fd_ = eventfd(0, EFD_CLOEXEC);
+    if (wakeup_fd_ == -1) {
+        throw std::runtime_error("eventfd failed");
+    }
+}
+
+UringReactor::~UringReactor() {
+    //      ,    
+    for (auto& pair : connections_) {
+        if (pair.second->open) on_client_disconnected(pair.second->client_id);
+        net_utils::socket_close(pair.first);
+    }
+    close(wakeup_fd_);
+}
+
+void UringReactor::stop() {
+    running_ = false;
+    wakeup();
+}
+
+void UringReactor::wakeup() {
+    uint64_t one = 1;
+    write(wakeup_fd_, &one, sizeof(one));
+    syscalls_.add();
+}
+
+bool UringReactor::on_own_thread() const {
+    return current_reactor == this;
+}
+
+void UringReactor::run() {
+    current_reactor = this;
+    std::cout << "io_uring reactor #" << shard_index_ << " started" << std::endl;
+    if (shard_index_ == 0 && client_manager.queue_limits().zerocopy_threshold > 0) {
+        std::cerr << "Zero-copy sends need the epoll reactor, sending by copy" << std::endl;
+    }
+
+    arm_accept();
+    arm_wakeup();
+
+    //          
+    int wait_ms = idle_timeout_ms_ ? (int)idle_timers_.tick_ms() : -1;
+
+    while (running_) {
+        //   (, )   -   
+        ring_.submit(1, wait_ms);
+        ring_.drain([this](const io_uring_cqe& cqe) { on_completion(cqe); });
+
+        flush_pending();
+        if (idle_timeout_ms_) {
+            expire_idle();
+        }
+    }
+
+    current_reactor = nullptr;
+    std::cout << "io_uring reactor #" << shard_index_ << " stopped" << std::endl;
+}
+
+//    ;     
+void UringReactor::expire_idle() {
+    idle_timers_.advance(TimerWheel::now_ms(), [this](uint64_t socket) {
+        auto it = connections_.find((int)socket);
+        if (it == connections_.end() || !it->second->open) return;
+
+        it->second->idle_timer = TimerWheel::NONE;
+        LOG_INFO("Idle timeout: client %d", it->second->client_id);
+        drop_client(*it->second);
+    });
+}
+
+void UringReactor::post_broadcast(const net_utils::SharedFrame& frame, int exclude_id) {
+    post_task({ Task::Broadcast, frame, -1, exclude_id, OverflowPolicy::DropOldest });
+}
+
+void UringReactor::post_to_client(int client_id, const net_utils::SharedFrame& frame) {
+    post_task({ Task::Direct, frame, client_id, -1, OverflowPolicy::DropOldest });
+}
+
+void UringReactor::post_overflow_policy(int client_id, OverflowPolicy policy) {
+    post_task({ Task::Policy, nullptr, client_id, -1, policy });
+}
+
+void UringReactor::post_to_members(const net_utils::SharedFrame& frame,
+    const RoomRouter::MemberList& members, int exclude_id) {
+    post_task({ Task::Members, frame, -1, exclude_id, OverflowPolicy::DropOldest, members });
+}
+
+bool UringReactor::post_file(int client_id, const net_utils::SharedFrame& announce,
+    const std::shared_ptr<StoredFile>& file, uint64_t offset) {
+    post_task({ Task::File, announce, client_id, -1, OverflowPolicy::DropOldest, nullptr, file, offset });
+    return true;
+}
+
+void UringReactor::post_task(Task task) {
+    //     ,  
+    if (on_own_thread()) {
+        run_task(task);
+        return;
+    }
+    task.posted_ns = Histogram::now_ns();
+    if (mailbox_.push(std::move(task))) {
+        wakeup();
+    }
+}
+
+void UringReactor::run_task(Task& task) {
+    if (task.kind == Task::Broadcast) {
+        for (auto& pair : connections_) {
+            if (pair.second->open && pair.second->client_id != task.exclude_id) {
+                enqueue(*pair.second, task.frame);
+            }
+        }
+        return;
+    }
+    if (task.kind == Task::Members) {
+        for (int id : *task.members) {
+            if (id == task.exclude_id) continue;
+            Connection* conn = find_client(id);
+            if (conn) enqueue(*conn, task.frame);
+        }
+        return;
+    }
+
+    Connection* conn = find_client(task.client_id);
+    if (!conn) return;
+
+    if (task.kind == Task::Direct) {
+        enqueue(*conn, task.frame);
+    }
+    else if (task.kind == Task::File) {
+        //    pump() ,     
+        conn->downloads.push_back({ task.file, task.offset, task.frame });
+        if (!conn->flush_pending) {
+            conn->flush_pending = true;
+            flush_list_.push_back(conn->socket);
+        }
+    }
+    else {
+        conn->outbox.set_policy(task.policy);
+    }
+}
+
+UringReactor::Connection* UringReactor::find_client(int client_id) {
+    auto id_it = sockets_by_id_.find(client_id);
+    if (id_it == sockets_by_id_.end()) return nullptr;
+
+    auto it = connections_.find(id_it->second);
+    return it != connections_.end() ? it->second.get() : nullptr;
+}
+
+//    ;    -  flush_pending()
+void UringReactor::enqueue(Connection& conn, const net_utils::SharedFrame& frame) {
+    if (conn.outbox.push(frame) == OutboundQueue::PushResult::Overflow) {
+        drop_client(conn);
+        return;
+    }
+    if (!conn.flush_pending) {
+        conn.flush_pending = true;
+        flush_list_.push_back(conn.socket);
+    }
+}
+
+//    ;        
+void UringReactor::flush_pending() {
+    for (size_t i = 0; i < flush_list_.size(); ++i) {
+        auto it = connections_.find(flush_list_[i]);
+        if (it == connections_.end()) continue;
+
+        Connection& conn = *it->second;
+        conn.flush_pending = false;
+        pump(conn);
+    }
+    flush_list_.clear();
+}
+
+//   :   ,   ,
+//      .   
+//      .
+void UringReactor::pump(Connection& conn) {
+    if (!conn.open || conn.sending) return;
+    if (conn.chunk_ready) start_chunk_send(conn);
+    else if (!conn.outbox.empty()) start_send(conn);
+    else if (conn.reading || conn.downloads.empty()) return;
+    else if (conn.downloads.front().announce) {
+        //    in_flight   
+        start_single_send(conn, conn.downloads.front().announce);
+        conn.downloads.front().announce.reset();
+    }
+    else start_read(conn);
+}
+
+//      in_flight      
+void UringReactor::start_send(Connection& conn) {
+    conn.in_flight.clear();
+    size_t offset = conn.outbox.pop_batch(conn.in_flight, net_utils::MAX_SLICES);
+
+    conn.slice_count = conn.in_flight.size();
+    for (size_t i = 0; i < conn.slice_count; ++i) {
+        const std::string& frame = *conn.in_flight[i];
+        size_t skip = i == 0 ? offset : 0;
+        conn.slices[i].iov_base = const_cast<char*>(frame.data()) + skip;
+        conn.slices[i].iov_len = frame.size() - skip;
+    }
+    conn.message = {};
+    conn.message.msg_iov = conn.slices;
+    conn.message.msg_iovlen = conn.slice_count;
+    submit_send(conn);
+}
+
+//    outbox;   in_flight
+void UringReactor::start_single_send(Connection& conn, const net_utils::SharedFrame& frame) {
+    conn.in_flight.clear();
+    conn.in_flight.push_back(frame);
+    conn.slice_count = 1;
+    conn.slices[0].iov_base = const_cast<char*>(frame->data());
+    conn.slices[0].iov_len = frame->size();
+    conn.message = {};
+    conn.message.msg_iov = conn.slices;
+    conn.message.msg_iovlen = 1;
+    submit_send(conn);
+}
+
+//   -   
+void UringReactor::start_chunk_send(Connection& conn) {
+    start_single_send(conn, conn.chunk);
+    conn.sending_chunk = true;
+}
+
+void UringReactor::submit_send(Connection& conn) {
+    io_uring_sqe* sqe = ring_.sqe();
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = conn.socket;
+    sqe->addr = (uint64_t)(uintptr_t)&conn.message;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = user_data(SEND, conn.socket);
+    conn.sending = true;
+}
+
+//  :    ,     
+void UringReactor::start_read(Connection& conn) {
+    Download& download = conn.downloads.front();
+    uint64_t left = download.file->size - std::min(download.offset, download.file->size);
+    size_t size = (size_t)std::min<uint64_t>(left, file_frame::CHUNK_SIZE);
+    uint8_t flags = size == left ? file_frame::FLAG_LAST : 0;
+    int length = (int)(file_frame::HEADER_SIZE + size);
+
+    if (!conn.chunk) conn.chunk = std::make_shared<std::string>();
+    conn.chunk->resize(CHUNK_HEADER_SIZE + size);
+    char* data = &(*conn.chunk)[0];
+    memcpy(data, &length, sizeof(length));
+    file_frame::encode_header(data + sizeof(length), download.file->id, download.offset, flags);
+    conn.chunk_read = 0;
+
+    //   -    
+    if (size == 0) {
+        conn.chunk_ready = true;
+        start_chunk_send(conn);
+        return;
+    }
+    submit_read(conn);
+}
+
+void UringReactor::submit_read(Connection& conn) {
+    const Download& download = conn.downloads.front();
+    size_t size = conn.chunk->size() - CHUNK_HEADER_SIZE;
+
+    io_uring_sqe* sqe = ring_.sqe();
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = download.file->fd;
+    sqe->addr = (uint64_t)(uintptr_t)(&(*conn.chunk)[CHUNK_HEADER_SIZE + conn.chunk_read]);
+    sqe->len = (uint32_t)(size - conn.chunk_read);
+    sqe->off = download.offset + conn.chunk_read;
+    sqe->user_data = user_data(READ, conn.socket);
+    conn.reading = true;
+}
+
+void UringReactor::drop_client(Connection& conn) {
+    //  shutdown   ,    close_client
+    client_manager.disconnect_client(conn.client_id);
+    net_utils::shutdown(conn.socket);
+}
+
+void UringReactor::arm_accept() {
+    io_uring_sqe* sqe = ring_.sqe();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listen_socket_;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->user_data = user_data(ACCEPT, listen_socket_);
+}
+
+void UringReactor::arm_receive(int socket) {
+    io_uring_sqe* sqe = ring_.sqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = socket;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = buffers_.group();
+    sqe->user_data = user_data(RECEIVE, socket);
+}
+
+void UringReactor::arm_wakeup() {
+    io_uring_sqe* sqe = ring_.sqe();
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = wakeup_fd_;
+    sqe->addr = (uint64_t)(uintptr_t)&wakeup_value_;
+    sqe->len = sizeof(wakeup_value_);
+    sqe->user_data = user_data(WAKEUP, wakeup_fd_);
+}
+
+void UringReactor::on_completion(const io_uring_cqe& cqe) {
+    Operation operation = (Operation)(cqe.user_data >> 56);
+    int socket = (int)(uint32_t)cqe.user_data;
+
+    if (operation == ACCEPT) {
+        on_accept(cqe);
+        return;
+    }
+    if (operation == WAKEUP) {
+        // : eventfd   ,   
+        mailbox_.drain([this](Task& task) { run_task(task); });
+        if (running_) arm_wakeup();
+        return;
+    }
+
+    auto it = connections_.find(socket);
+    if (it == connections_.end()) {
+        if (cqe.flags & IORING_CQE_F_BUFFER) buffers_.put(ProvidedBuffers::id_of(cqe));
+        return;
+    }
+    if (operation == RECEIVE) on_receive(*it->second, cqe);
+    else if (operation == READ) on_read(*it->second, cqe);
+    else on_sent(*it->second, cqe);
+}
+
+void UringReactor::on_accept(const io_uring_cqe& cqe) {
+    // Multishot-  (,  ) -  .
+    //    (EBADF, ENOTSOCK, EINVAL) -  .
+    bool fatal = cqe.res == -EBADF || cqe.res == -ENOTSOCK || cqe.res == -EINVAL;
+    if (!(cqe.flags & IORING_CQE_F_MORE) && running_ && !fatal) arm_accept();
+
+    if (cqe.res < 0) {
+        if (cqe.res != -ECANCELED) LOG_ERROR("Error accept: %d", -cqe.res);
+        return;
+    }
+
+    int client_socket = cqe.res;
+    // Multishot accept    -   
+    struct sockaddr_in client_addr;
+    socklen_t client_len = sizeof(client_addr);
+    memset(&client_addr, 0, sizeof(client_addr));
+    getpeername(client_socket, (struct sockaddr*)&client_addr, &client_len);
+    syscalls_.add();
+
+    int client_id = client_manager.add_client(client_socket, client_addr, shard_index_);
+    if (!client_id) {
+        LOG_WARN("Client table is full, connection rejected");
+        close(client_socket);
+        return;
+    }
+    TimerWheel::Handle idle_timer = idle_timeout_ms_ ?
+        idle_timers_.arm(client_socket, idle_timeout_ms_, TimerWheel::now_ms()) : TimerWheel::NONE;
+    connections_[client_socket].reset(new Connection{ client_socket, client_id,
+        net_utils::FrameDecoder(max_frame_size_),
+        OutboundQueue(client_manager.queue_limits()), false, idle_timer, true, false, {}, {}, 0, {} });
+    sockets_by_id_[client_id] = client_socket;
+    arm_receive(client_socket);
+
+    on_client_connected(client_id, client_addr);
+
+    LOG_INFO("Total clients: %zu", client_manager.get_client_count());
+}
+
+//      :   ,   
+void UringReactor::on_receive(Connection& conn, const io_uring_cqe& cqe) {
+    bool more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+
+    if (cqe.res > 0 && (cqe.flags & IORING_CQE_F_BUFFER)) {
+        uint16_t id = ProvidedBuffers::id_of(cqe);
+        if (conn.open) conn.decoder.append(buffers_.data(id), (size_t)cqe.res);
+        buffers_.put(id);
+    }
+    if (!conn.open) {
+        if (!more) release(conn);
+        return;
+    }
+
+    if (cqe.res > 0) {
+        if (conn.idle_timer != TimerWheel::NONE) {
+            idle_timers_.rearm(conn.idle_timer, idle_timeout_ms_, TimerWheel::now_ms());
+        }
+
+        std::string message;
+        while (conn.decoder.next_frame(message)) {
+            if (!message.empty() && !on_client_message(conn.client_id, message)) {
+                drop_client(conn);
+                break;
+            }
+        }
+        if (conn.decoder.failed()) {
+            LOG_WARN("Bad frame from client %d, disconnecting", conn.client_id);
+            drop_client(conn);
+        }
+        //      multishot -  
+        if (!more) arm_receive(conn.socket);
+        return;
+    }
+
+    //     - ,  ,   
+    if (cqe.res == -ENOBUFS) {
+        if (!more) arm_receive(conn.socket);
+        return;
+    }
+
+    // 0 -    (   shutdown),  
+    if (!more) close_client(conn);
+}
+
+void UringReactor::on_sent(Connection& conn, const io_uring_cqe& cqe) {
+    conn.sending = false;
+    if (cqe.res < 0) {
+        conn.in_flight.clear();
+        conn.sending_chunk = false;
+        if (conn.open) drop_client(conn);
+        else release(conn);
+        return;
+    }
+
+    OutboundMetrics::get().sent_bytes.add((uint64_t)cqe.res);
+
+    //    -     
+    size_t done = (size_t)cqe.res;
+    size_t first = 0;
+    while (first < conn.slice_count && done >= conn.slices[first].iov_len) {
+        done -= conn.slices[first].iov_len;
+        ++first;
+    }
+    if (first < conn.slice_count && conn.open) {
+        conn.slices[first].iov_base = static_cast<char*>(conn.slices[first].iov_base) + done;
+        conn.slices[first].iov_len -= done;
+        conn.message.msg_iov = conn.slices + first;
+        conn.message.msg_iovlen = conn.slice_count - first;
+        submit_send(conn);
+        return;
+    }
+
+    conn.in_flight.clear();
+    if (conn.sending_chunk) {
+        conn.sending_chunk = false;
+        if (conn.open) on_chunk_sent(conn);
+    }
+    if (!conn.open) {
+        release(conn);
+        return;
+    }
+    pump(conn);
+}
+
+//   :  ,    
+void UringReactor::on_chunk_sent(Connection& conn) {
+    Download& download = conn.downloads.front();
+    size_t size = conn.chunk->size() - CHUNK_HEADER_SIZE;
+    conn.chunk_ready = false;
+    download.offset += size;
+    DownloadMetrics::get().bytes.add(size);
+
+    if (download.offset >= download.file->size) {
+        //    -     
+        file_store.downloaded(*download.file, conn.client_id);
+        conn.downloads.pop_front();
+        DownloadMetrics::get().files.add();
+    }
+    else if (conn.downloads.size() > 1) {
+        conn.downloads.push_back(std::move(download));
+        conn.downloads.pop_front();
+    }
+}
+
+void UringReactor::on_read(Connection& conn, const io_uring_cqe& cqe) {
+    conn.reading = false;
+    if (!conn.open) {
+        release(conn);
+        return;
+    }
+    // 0 -     
+    if (cqe.res <= 0) {
+        LOG_WARN("Cannot read file %u for client %d: %d", conn.downloads.front().file->id,
+            conn.client_id, -cqe.res);
+        drop_client(conn);
+        return;
+    }
+
+    conn.chunk_read += (size_t)cqe.res;
+    if (conn.chunk_read < conn.chunk->size() - CHUNK_HEADER_SIZE) {
+        submit_read(conn);
+        return;
+    }
+    conn.chunk_ready = true;
+    pump(conn);
+}
+
+//     ,   -    
+void UringReactor::close_client(Connection& conn) {
+    int client_id = conn.client_id;
+    conn.open = false;
+    idle_timers_.cancel(conn.idle_timer);
+    conn.idle_timer = TimerWheel::NONE;
+    sockets_by_id_.erase(client_id);
+
+    on_client_disconnected(client_id);
+    release(conn);
+}
+
+//  ,  ,      -   
+// (   )
+void UringReactor::release(Connection& conn) {
+    if (conn.sending || conn.reading) return;
+    int socket = conn.socket;
+    connections_.erase(socket);
+    net_utils::socket_close(socket);
+    syscalls_.add();
+}
+#endif
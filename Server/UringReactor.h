@@ -0,0 +1,151 @@
+#pragma once
+#include "Uring.h"
+
+#ifdef NET_URING
+#include "ClientManager.h"
+#include "FileStore.h"
+#include "Mailbox.h"
+#include "OutboundQueue.h"
+#include "TimerWheel.h"
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+//    io_uring,  EpollReactor     .
+//     - multishot- (     ),
+//       .     
+//    io_uring_enter    .
+//      :     (READ)
+//       .
+class UringReactor : public ClientShard {
+private:
+    // ,   :    
+    struct Download {
+        std::shared_ptr<StoredFile> file;
+        uint64_t offset;
+        net_utils::SharedFrame announce;    // FILE BEGIN,   
+    };
+
+    static const size_t CHUNK_HEADER_SIZE = sizeof(int) + file_frame::HEADER_SIZE;
+
+    struct Connection {
+        net_utils::socket_t socket;     //  
+        int client_id;                  // ID  ClientManager
+        net_utils::FrameDecoder decoder;    //     
+        OutboundQueue outbox;           // ,    
+        bool flush_pending;             //      
+        TimerWheel::Handle idle_timer;  //   (NONE - )
+        bool open;                      //  ; false -     
+        bool sending;                   // sendmsg  :   iov   
+        std::vector<net_utils::SharedFrame> in_flight;
+        iovec slices[net_utils::MAX_SLICES];
+        size_t slice_count;
+        msghdr message;
+        //    ,  :  ,  outbox ,
+        //     .  ,     
+        //  outbox -     .
+        std::deque<Download> downloads{};
+        std::shared_ptr<std::string> chunk{};   // [int ][][]
+        size_t chunk_read = 0;          //     
+        bool reading = false;           // READ  : chunk  
+        bool chunk_ready = false;       //     
+        bool sending_chunk = false;     //    ,   
+    };
+
+    //     (  EpollReactor)
+    struct Task {
+        enum Kind { Broadcast, Direct, Policy, Members, File } kind;
+        net_utils::SharedFrame frame;   //  File -    
+        int client_id;
+        int exclude_id;
+        OverflowPolicy policy;
+        RoomRouter::MemberList members{};
+        std::shared_ptr<StoredFile> file{};
+        uint64_t offset = 0;
+        uint64_t posted_ns = 0;
+    };
+
+    //   -    user_data,   - 
+    enum Operation : uint64_t {
+        ACCEPT = 1,
+        RECEIVE = 2,
+        SEND = 3,
+        WAKEUP = 4,
+        READ = 5            //    ;    -  
+    };
+
+    static const unsigned RING_ENTRIES = 1024;
+    static const unsigned BUFFER_COUNT = 512;       //  
+    static const size_t BUFFER_SIZE = 16384;
+    static const uint16_t BUFFER_GROUP = 0;
+
+    net_utils::socket_t listen_socket_;
+    int shard_index_;
+    size_t max_frame_size_;
+    uint64_t idle_timeout_ms_;
+    TimerWheel idle_timers_;            //  - 
+    Counter& syscalls_;
+    IoUring ring_;
+    ProvidedBuffers buffers_;
+    int wakeup_fd_;                     // eventfd:    
+    uint64_t wakeup_value_ = 0;         //    WAKEUP
+    std::atomic<bool> running_{ true };
+    //  ,        (  )
+    std::unordered_map<int, std::unique_ptr<Connection>> connections_;  //  - 
+    std::unordered_map<int, int> sockets_by_id_;        // ID  -> 
+    std::vector<int> flush_list_;
+    Mailbox<Task> mailbox_;
+public:
+    //  runtime_error,  io_uring  ( ,   )
+    UringReactor(net_utils::socket_t listen_socket, int shard_index = 0,
+        size_t max_frame_size = net_utils::MAX_FRAME_SIZE, uint64_t idle_timeout_ms = 0);
+    ~UringReactor();
+
+    void run();
+    void stop();
+
+    // ClientShard:     
+    void post_broadcast(const net_utils::SharedFrame& frame, int exclude_id) override;
+    void post_to_client(int client_id, const net_utils::SharedFrame& frame) override;
+    void post_overflow_policy(int client_id, OverflowPolicy policy) override;
+    void post_to_members(const net_utils::SharedFrame& frame,
+        const RoomRouter::MemberList& members, int exclude_id) override;
+    bool post_file(int client_id, const net_utils::SharedFrame& announce,
+        const std::shared_ptr<StoredFile>& file, uint64_t offset) override;
+private:
+    static uint64_t user_data(Operation operation, int socket) {
+        return (uint64_t)operation << 56 | (uint32_t)socket;
+    }
+
+    bool on_own_thread() const;
+    void wakeup();
+    void post_task(Task task);
+    void run_task(Task& task);
+    Connection* find_client(int client_id);
+    void enqueue(Connection& conn, const net_utils::SharedFrame& frame);
+    void flush_pending();
+    void pump(Connection& conn);
+    void start_send(Connection& conn);
+    void start_single_send(Connection& conn, const net_utils::SharedFrame& frame);
+    void start_chunk_send(Connection& conn);
+    void submit_send(Connection& conn);
+    void start_read(Connection& conn);
+    void submit_read(Connection& conn);
+    void drop_client(Connection& conn);
+    void expire_idle();
+
+    void arm_accept();
+    void arm_receive(int socket);
+    void arm_wakeup();
+    void on_completion(const io_uring_cqe& cqe);
+    void on_accept(const io_uring_cqe& cqe);
+    void on_receive(Connection& conn, const io_uring_cqe& cqe);
+    void on_sent(Connection& conn, const io_uring_cqe& cqe);
+    void on_read(Connection& conn, const io_uring_cqe& cqe);
+    void on_chunk_sent(Connection& conn);
+    void close_client(Connection& conn);
+    void release(Connection& conn);
+};
+#endif
@@ -1,22 +1,165 @@
 #include "Server.h"
 #include "ServerUDP.h"
+#include "Logger.h"
+#include "MetricsEndpoint.h"
 
 #include <iostream>
+#include <memory>
 #include <string>
 #include <Windows.h>
 
-int main() {
+int main(int argc, char* argv[]) {
+    // : --log-level=debug|info|warn|error|off (  info),
+    // --log-sample=N (Debug/Info -  N-), --log-file=PATH (  stdout).
+    // : --metrics-port=N (GET /metrics  127.0.0.1)
+    int metrics_port = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        LogLevel level;
+        if (arg.rfind("--log-level=", 0) == 0) {
+            if (Logger::parse_level(arg.c_str() + 12, level)) Logger::instance().set_level(level);
+            else std::cerr << "Unknown log level: " << arg.substr(12) << std::endl;
+        }
+        else if (arg.rfind("--log-sample=", 0) == 0) {
+            Logger::instance().set_sample_every(std::stoul(arg.substr(13)));
+        }
+        else if (arg.rfind("--log-file=", 0) == 0) {
+            //     
+            FILE* file = fopen(arg.c_str() + 11, "a");
+            if (file) Logger::instance().set_output(file);
+            else std::cerr << "Cannot open log file: " << arg.substr(11) << std::endl;
+        }
+        else if (arg.rfind("--metrics-port=", 0) == 0) {
+            metrics_port = std::stoi(arg.substr(15));
+        }
+    }
+
+    //   :      
+    std::unique_ptr<MetricsEndpoint> metrics;
+    if (metrics_port) {
+        try {
+            metrics.reset(new MetricsEndpoint(metrics_port));
+            std::cout << "Metrics: http://127.0.0.1:" << metrics_port << "/metrics" << std::endl;
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
     #ifdef TCP
+    ServerConfig config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--epoll") config.mode = ServerMode::Epoll;
+        else if (arg == "--threads") config.mode = ServerMode::Threaded;
+        else if (arg == "--uring") config.mode = ServerMode::Uring;
+        else if (arg.rfind("--reactors=", 0) == 0) {
+            if (config.mode != ServerMode::Uring) config.mode = ServerMode::Epoll;
+            config.reactors = std::stoi(arg.substr(11));
+        }
+        else if (arg == "--pin") config.pin_threads = true;
+        else if (arg.rfind("--high-watermark=", 0) == 0) {
+            config.queue_limits.high_watermark = std::stoul(arg.substr(17));
+        }
+        else if (arg.rfind("--low-watermark=", 0) == 0) {
+            config.queue_limits.low_watermark = std::stoul(arg.substr(16));
+        }
+        else if (arg == "--overflow=oldest") config.queue_limits.policy = OverflowPolicy::DropOldest;
+        else if (arg == "--overflow=newest") config.queue_limits.policy = OverflowPolicy::DropNewest;
+        else if (arg == "--overflow=disconnect") config.queue_limits.policy = OverflowPolicy::Disconnect;
+        //       ( epoll-)
+        else if (arg == "--zerocopy" || arg.rfind("--zerocopy=", 0) == 0) {
+            if (config.mode == ServerMode::Threaded) config.mode = ServerMode::Epoll;
+            config.queue_limits.zerocopy_threshold = arg.size() > 11 ? std::stoul(arg.substr(11)) : 16384;
+        }
+        else if (arg.rfind("--file-dir=", 0) == 0) {
+            config.file_directory = arg.substr(11);
+        }
+        else if (arg.rfind("--max-file=", 0) == 0) {
+            config.file_limits.max_size = std::stoull(arg.substr(11));
+        }
+        //      (0 -   )
+        else if (arg.rfind("--file-ttl=", 0) == 0) {
+            config.file_limits.ttl_ms = std::stoull(arg.substr(11)) * 1000;
+        }
+        //  :    ;   
+        else if (arg.rfind("--file-count=", 0) == 0) {
+            config.file_limits.max_owner_files = std::stoul(arg.substr(13));
+        }
+        else if (arg.rfind("--file-quota=", 0) == 0) {
+            config.file_limits.max_owner_bytes = std::stoull(arg.substr(13));
+        }
+        else if (arg.rfind("--file-total=", 0) == 0) {
+            config.file_limits.max_total_bytes = std::stoull(arg.substr(13));
+        }
+        //     :   , --history=DIR 
+        else if (arg.rfind("--history=", 0) == 0) {
+            config.history.directory = arg.substr(10);
+        }
+        else if (arg.rfind("--history-segment=", 0) == 0) {
+            config.history.segment_size = std::stoul(arg.substr(18));
+        }
+        else if (arg.rfind("--history-retain=", 0) == 0) {
+            config.history.retain_bytes = std::stoull(arg.substr(17));
+        }
+        else if (arg.rfind("--history-age=", 0) == 0) {
+            config.history.retain_ms = std::stoull(arg.substr(14)) * 1000;
+        }
+        else if (arg.rfind("--history-replay=", 0) == 0) {
+            config.history.replay_count = std::stoul(arg.substr(17));
+        }
+        else if (arg.rfind("--max-frame=", 0) == 0) {
+            config.max_frame_size = std::stoul(arg.substr(12));
+        }
+        else if (arg.rfind("--idle-timeout=", 0) == 0) {
+            config.idle_timeout_ms = std::stoull(arg.substr(15)) * 1000;
+        }
+    }
+
     try {
-    runServer();
+        if (runServer(config) != 0) return 1;
     }
     catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
     }
     #else
+    UdpServerConfig config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--batch=", 0) == 0) {
+            config.batch_size = std::stoul(arg.substr(8));
+        }
+        else if (arg == "--uring") config.uring = true;
+        else if (arg.rfind("--workers=", 0) == 0) {
+            config.workers = std::stoul(arg.substr(10));
+        }
+        else if (arg.rfind("--client-timeout=", 0) == 0) {
+            config.client_timeout_ms = std::stoull(arg.substr(17)) * 1000;
+        }
+        else if (arg.rfind("--multicast=", 0) == 0) {
+            config.multicast_group = arg.substr(12);
+        }
+        else if (arg.rfind("--ttl=", 0) == 0) {
+            config.multicast_ttl = std::stoi(arg.substr(6));
+        }
+        else if (arg == "--no-loopback") config.multicast_loopback = false;
+        else if (arg.rfind("--rate=", 0) == 0) {
+            config.tick_rate = std::stod(arg.substr(7));
+        }
+        else if (arg.rfind("--retransmit-window=", 0) == 0) {
+            config.retransmit_window = std::stoul(arg.substr(20));
+        }
+        else if (arg.rfind("--retransmit-rate=", 0) == 0) {
+            config.retransmit_rate = std::stod(arg.substr(18));
+        }
+        else if (arg == "--binary-radio") config.binary_radio = true;
+        else if (arg == "--radio-checksum") config.radio_checksum = true;
+    }
+
     try {
-        UdpRadioServer server;
+        UdpRadioServer server(config);
         server.start();
     }
     catch (const std::exception& e) {